@@ -0,0 +1,95 @@
+#ifndef BEHAVIORAL_PATTERNS_COMMON_EXECUTOR_H_
+#define BEHAVIORAL_PATTERNS_COMMON_EXECUTOR_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Fixed-size thread pool running submitted tasks in FIFO order.
+ *
+ * Meant to be shared by many contexts and runners. The destructor runs every
+ * task still queued, including tasks submitted by running tasks, then joins the
+ * workers.
+ */
+class Executor {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param threads Number of worker threads
+   */
+  explicit Executor(size_t threads = std::thread::hardware_concurrency()) {
+    for (size_t i = 0; i < (threads ? threads : 1); ++i) {
+      workers_.emplace_back([this] { work(); });
+    }
+  }
+
+  Executor(const Executor &) = delete;
+  Executor(Executor &&) = delete;
+  Executor operator=(const Executor &) = delete;
+  Executor operator=(Executor &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~Executor() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /**
+   * @brief Queue a task
+   */
+  void submit(std::function<void()> task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    ready_.notify_one();
+  }
+
+ private:
+  /**
+   * @brief Worker loop
+   */
+  void work() {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ready_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+        if (tasks_.empty()) return;
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  /**
+   * @brief Worker threads
+   */
+  std::vector<std::thread> workers_;
+
+  /**
+   * @brief Queued tasks and shutdown flag, guarded by `mutex_`
+   */
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<std::function<void()>> tasks_;
+  bool stopping_{false};
+};
+
+#endif  // BEHAVIORAL_PATTERNS_COMMON_EXECUTOR_H_
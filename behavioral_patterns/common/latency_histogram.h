@@ -0,0 +1,124 @@
+#ifndef BEHAVIORAL_PATTERNS_COMMON_LATENCY_HISTOGRAM_H_
+#define BEHAVIORAL_PATTERNS_COMMON_LATENCY_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+/**
+ * @brief Latency counters shared by concurrent threads: number of calls, total
+ * time and a log2 histogram.
+ *
+ * The counters are split in a few cache-line sized stripes. A thread always
+ * updates the same stripe with relaxed atomics, so threads recording at once
+ * rarely share a cache line. snapshot() sums the stripes and may run from any
+ * thread while latencies are recorded.
+ */
+class LatencyHistogram {
+ public:
+  /**
+   * @brief Number of latency buckets, bucket `b` counts latencies in
+   * [2^(b-1), 2^b) nanoseconds (bucket 0 counts 0ns, the last one is open).
+   */
+  static constexpr size_t cBuckets{40};
+
+  /**
+   * @brief Counters summed over every stripe
+   */
+  struct Snapshot {
+    uint64_t calls{0};
+    uint64_t total_ns{0};
+    std::array<uint64_t, cBuckets> histogram{};
+
+    /**
+     * @brief Upper bound of the bucket holding the `q` quantile, in ns
+     */
+    uint64_t quantile_ns(double q) const {
+      uint64_t seen = 0;
+      for (size_t b = 0; b < cBuckets; ++b) {
+        seen += histogram[b];
+        if (seen && seen >= q * calls) return uint64_t{1} << b;
+      }
+      return 0;
+    }
+  };
+
+  /**
+   * @brief Constructor
+   */
+  LatencyHistogram() = default;
+
+  LatencyHistogram(const LatencyHistogram &) = delete;
+  LatencyHistogram(LatencyHistogram &&) = delete;
+  LatencyHistogram operator=(const LatencyHistogram &) = delete;
+  LatencyHistogram operator=(LatencyHistogram &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~LatencyHistogram() = default;
+
+  /**
+   * @brief Record one call lasting `ns`
+   */
+  void record(uint64_t ns) {
+    static thread_local const size_t stripe =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) % cStripes;
+    Stripe &s = stripes_[stripe];
+    s.calls.fetch_add(1, std::memory_order_relaxed);
+    s.total_ns.fetch_add(ns, std::memory_order_relaxed);
+    s.histogram[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Sum of the stripes
+   */
+  Snapshot snapshot() const {
+    Snapshot snapshot;
+    for (const Stripe &s : stripes_) {
+      snapshot.calls += s.calls.load(std::memory_order_relaxed);
+      snapshot.total_ns += s.total_ns.load(std::memory_order_relaxed);
+      for (size_t b = 0; b < cBuckets; ++b) {
+        snapshot.histogram[b] += s.histogram[b].load(std::memory_order_relaxed);
+      }
+    }
+    return snapshot;
+  }
+
+  /**
+   * @brief Histogram bucket of a latency: its bit width, capped
+   */
+  static size_t bucket_of(uint64_t ns) {
+    size_t bits = 0;
+    while (ns && bits + 1 < cBuckets) {
+      ns >>= 1;
+      ++bits;
+    }
+    return bits;
+  }
+
+ private:
+  /**
+   * @brief Number of stripes
+   */
+  static constexpr size_t cStripes{8};
+
+  /**
+   * @brief Counters of one stripe, on their own cache lines
+   */
+  struct alignas(64) Stripe {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::array<std::atomic<uint64_t>, cBuckets> histogram{};
+  };
+
+  /**
+   * @brief Stripes
+   */
+  std::array<Stripe, cStripes> stripes_;
+};
+
+#endif  // BEHAVIORAL_PATTERNS_COMMON_LATENCY_HISTOGRAM_H_
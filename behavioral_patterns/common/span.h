@@ -0,0 +1,59 @@
+#ifndef BEHAVIORAL_PATTERNS_COMMON_SPAN_H_
+#define BEHAVIORAL_PATTERNS_COMMON_SPAN_H_
+
+#include <cstddef>
+
+/**
+ * @brief Non-owning view over a contiguous sequence, a minimal stand-in for
+ * C++20 std::span.
+ */
+template <typename T>
+class Span {
+ public:
+  /**
+   * @brief Constructor, empty view
+   */
+  constexpr Span() = default;
+
+  /**
+   * @brief Constructor
+   *
+   * @param data First element
+   * @param size Number of elements
+   */
+  constexpr Span(T *data, size_t size) : data_(data), size_(size){};
+
+  /**
+   * @brief Constructor, views a whole array
+   */
+  template <size_t N>
+  constexpr Span(T (&array)[N]) : data_(array), size_(N){};
+
+  /**
+   * @brief Constructor, views a whole contiguous container (std::vector,
+   * std::array, ...)
+   */
+  template <typename Container>
+  constexpr Span(Container &container)
+      : data_(container.data()), size_(container.size()){};
+
+  constexpr T *data() const { return data_; }
+  constexpr size_t size() const { return size_; }
+  constexpr bool empty() const { return size_ == 0; }
+  constexpr T &operator[](size_t i) const { return data_[i]; }
+  constexpr T *begin() const { return data_; }
+  constexpr T *end() const { return data_ + size_; }
+
+ private:
+  /**
+   * @brief First element
+   */
+  T *data_{nullptr};
+
+  /**
+   * @brief Number of elements
+   */
+  size_t size_{0};
+};
+
+#endif  // BEHAVIORAL_PATTERNS_COMMON_SPAN_H_
@@ -0,0 +1,165 @@
+#ifndef BEHAVIORAL_PATTERNS_STRATEGY_ADAPTIVE_CONTEXT_H_
+#define BEHAVIORAL_PATTERNS_STRATEGY_ADAPTIVE_CONTEXT_H_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "strategy.h"
+
+/**
+ * @brief AdaptiveContext holds several candidate strategies and routes each
+ * call to the one measured fastest for the class of its input.
+ *
+ * Inputs are classified by the magnitude of their length. Per class, each
+ * candidate keeps an exponentially weighted average of its latency. Untried
+ * candidates are sampled first, then the fastest one is exploited, and every
+ * `explore_period`-th call re-samples the next candidate in turn so that the
+ * choice follows the data when its shape changes (epsilon-greedy bandit).
+ */
+class AdaptiveContext {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param explore_period One call out of `explore_period` re-samples a
+   * candidate instead of using the fastest one
+   */
+  explicit AdaptiveContext(size_t explore_period = 16)
+      : explore_period_(explore_period){};
+
+  AdaptiveContext(const AdaptiveContext &) = delete;
+  AdaptiveContext(AdaptiveContext &&) = delete;
+  AdaptiveContext operator=(const AdaptiveContext &) = delete;
+  AdaptiveContext operator=(AdaptiveContext &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~AdaptiveContext() = default;
+
+  /**
+   * @brief Add a candidate strategy
+   */
+  void add_strategy(std::unique_ptr<Strategy> &&strategy) {
+    strategies_.push_back(std::move(strategy));
+    for (auto &arms : stats_) {
+      arms.emplace_back();
+    }
+  }
+
+  /**
+   * @brief Execute the candidate selected for the class of `data`, and update
+   * its latency estimate.
+   *
+   * @param data Data
+   */
+  void do_something(const char *data = nullptr) {
+    if (strategies_.empty()) {
+      fprintf(stdout, "AdaptiveContext: Strategy isn't set\n");
+      return;
+    }
+
+    auto &arms = stats_[input_class(data)];
+    const size_t index = select(arms);
+
+    fprintf(stdout, "AdaptiveContext: Execute strategy %zu:\n", index);
+    const auto start = std::chrono::steady_clock::now();
+    const std::string result = strategies_[index]->execute(data);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    fprintf(stdout, "%s\n", result.c_str());
+
+    const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    Arm &arm = arms[index];
+    arm.mean_ns = arm.samples ? arm.mean_ns + cAlpha * (ns - arm.mean_ns) : ns;
+    ++arm.samples;
+  }
+
+  /**
+   * @brief Index of the candidate currently considered fastest for `data`, or
+   * the number of candidates if none has been measured yet.
+   */
+  size_t fastest(const char *data = nullptr) const {
+    const auto &arms = stats_[input_class(data)];
+    const size_t none = strategies_.size();
+    size_t best = none;
+    for (size_t i = 0; i < strategies_.size(); ++i) {
+      if (!arms[i].samples) continue;
+      if (best == none || arms[i].mean_ns < arms[best].mean_ns) best = i;
+    }
+    return best;
+  }
+
+ private:
+  /**
+   * @brief Latency estimate of one candidate for one input class
+   */
+  struct Arm {
+    double mean_ns{0.0};
+    size_t samples{0};
+  };
+
+  /**
+   * @brief Number of input classes
+   */
+  static constexpr size_t cInputClasses{16};
+
+  /**
+   * @brief Smoothing factor of the latency averages
+   */
+  static constexpr double cAlpha{0.2};
+
+  /**
+   * @brief Input class: bit width of the input length (0 for no input).
+   */
+  static size_t input_class(const char *data) {
+    size_t length = data ? strlen(data) : 0;
+    size_t bits = 0;
+    while (length && bits + 1 < cInputClasses) {
+      length >>= 1;
+      ++bits;
+    }
+    return bits;
+  }
+
+  /**
+   * @brief Select the candidate to run for one input class
+   */
+  size_t select(std::vector<Arm> &arms) {
+    for (size_t i = 0; i < arms.size(); ++i) {
+      if (!arms[i].samples) return i;
+    }
+    if (explore_period_ && ++calls_ % explore_period_ == 0) {
+      return explore_next_++ % arms.size();
+    }
+    size_t best = 0;
+    for (size_t i = 1; i < arms.size(); ++i) {
+      if (arms[i].mean_ns < arms[best].mean_ns) best = i;
+    }
+    return best;
+  }
+
+  /**
+   * @brief Candidate strategies
+   */
+  std::vector<std::unique_ptr<Strategy>> strategies_;
+
+  /**
+   * @brief Latency estimates, per input class and per candidate
+   */
+  std::array<std::vector<Arm>, cInputClasses> stats_;
+
+  /**
+   * @brief Exploration settings and state
+   */
+  size_t explore_period_{16};
+  size_t calls_{0};
+  size_t explore_next_{0};
+};
+
+#endif  // BEHAVIORAL_PATTERNS_STRATEGY_ADAPTIVE_CONTEXT_H_
@@ -0,0 +1,223 @@
+#ifndef BEHAVIORAL_PATTERNS_STRATEGY_ASYNC_CONTEXT_H_
+#define BEHAVIORAL_PATTERNS_STRATEGY_ASYNC_CONTEXT_H_
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "executor.h"
+#include "strategy.h"
+
+/**
+ * @brief AsyncContext submits strategy calls to a shared Executor and returns
+ * immediately, with a future or a completion callback.
+ *
+ * Any number of calls may be in flight. At most `max_in_flight` of them run
+ * the same strategy at once, the others wait in a per-strategy queue without
+ * holding a worker thread. Calls keep the strategy they were submitted with
+ * alive, so set_strategy() never waits for them.
+ *
+ * @note The executor must outlive the context and its in-flight calls.
+ */
+class AsyncContext {
+ public:
+  /**
+   * @brief Completion callback, receives the result or the exception thrown by
+   * the strategy (the result is then empty). Runs on an executor thread, an
+   * exception it throws is dropped.
+   */
+  using Callback = std::function<void(std::string, std::exception_ptr)>;
+
+  AsyncContext() = delete;
+
+  /**
+   * @brief Constructor
+   *
+   * @param executor Executor running the calls
+   * @param strategy Strategy
+   * @param max_in_flight Maximum number of concurrent calls per strategy
+   */
+  explicit AsyncContext(Executor &executor,
+                        std::unique_ptr<Strategy> &&strategy = nullptr,
+                        size_t max_in_flight = 1)
+      : executor_(executor), max_in_flight_(max_in_flight ? max_in_flight : 1) {
+    set_strategy(std::move(strategy));
+  }
+
+  AsyncContext(const AsyncContext &) = delete;
+  AsyncContext(AsyncContext &&) = delete;
+  AsyncContext operator=(const AsyncContext &) = delete;
+  AsyncContext operator=(AsyncContext &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~AsyncContext() = default;
+
+  /**
+   * @brief Strategy setter, later calls use the new strategy while calls
+   * already submitted finish on the previous one.
+   */
+  void set_strategy(std::unique_ptr<Strategy> &&strategy) {
+    std::shared_ptr<Lane> lane;
+    if (strategy) {
+      lane = std::make_shared<Lane>(executor_, std::move(strategy),
+                                    max_in_flight_);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    lane_ = std::move(lane);
+  }
+
+  /**
+   * @brief Run the strategy on `data` asynchronously and call `done` with the
+   * outcome.
+   *
+   * @param data Data, copied
+   * @param done Completion callback
+   */
+  void execute_async(const char *data, Callback done) const {
+    std::shared_ptr<Lane> lane;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      lane = lane_;
+    }
+    if (!lane) {
+      executor_.submit([done = std::move(done)] {
+        complete(done, std::string(),
+                 std::make_exception_ptr(
+                     std::logic_error("AsyncContext: Strategy isn't set")));
+      });
+      return;
+    }
+    Lane::submit(lane,
+                 Call{data != nullptr, data ? data : "", std::move(done)});
+  }
+
+  /**
+   * @brief Run the strategy on `data` asynchronously.
+   *
+   * @param data Data, copied
+   * @return std::future<std::string>
+   */
+  std::future<std::string> execute_async(const char *data = nullptr) const {
+    auto promise = std::make_shared<std::promise<std::string>>();
+    auto future = promise->get_future();
+    execute_async(data,
+                  [promise](std::string result, std::exception_ptr error) {
+                    if (error) {
+                      promise->set_exception(error);
+                    } else {
+                      promise->set_value(std::move(result));
+                    }
+                  });
+    return future;
+  }
+
+ private:
+  /**
+   * @brief Call `done` with the outcome, dropping any exception it throws so
+   * that it never escapes an executor task
+   */
+  static void complete(const Callback &done, std::string result,
+                       std::exception_ptr error) {
+    try {
+      done(std::move(result), error);
+    } catch (...) {
+    }
+  }
+
+  /**
+   * @brief One submitted call
+   */
+  struct Call {
+    bool has_data;
+    std::string data;
+    Callback done;
+  };
+
+  /**
+   * @brief Calls of one strategy, bounded to `limit` running at once
+   */
+  struct Lane {
+    Lane(Executor &executor, std::unique_ptr<Strategy> &&strategy,
+         size_t limit)
+        : executor(executor), strategy(std::move(strategy)), limit(limit) {}
+
+    /**
+     * @brief Start `call` now if under the limit, queue it otherwise
+     */
+    static void submit(const std::shared_ptr<Lane> &lane, Call &&call) {
+      {
+        std::lock_guard<std::mutex> lock(lane->mutex);
+        if (lane->running == lane->limit) {
+          lane->pending.push_back(std::move(call));
+          return;
+        }
+        ++lane->running;
+      }
+      start(lane, std::move(call));
+    }
+
+    /**
+     * @brief Run `call` on the executor, then the next queued call if any
+     */
+    static void start(const std::shared_ptr<Lane> &lane, Call &&call) {
+      auto shared_call = std::make_shared<Call>(std::move(call));
+      lane->executor.submit([lane, shared_call] {
+        std::string result;
+        std::exception_ptr error;
+        try {
+          result = lane->strategy->execute(
+              shared_call->has_data ? shared_call->data.c_str() : nullptr);
+        } catch (...) {
+          error = std::current_exception();
+        }
+        complete(shared_call->done, std::move(result), error);
+
+        Call next;
+        {
+          std::lock_guard<std::mutex> lock(lane->mutex);
+          if (lane->pending.empty()) {
+            --lane->running;
+            return;
+          }
+          next = std::move(lane->pending.front());
+          lane->pending.pop_front();
+        }
+        start(lane, std::move(next));
+      });
+    }
+
+    Executor &executor;
+    const std::unique_ptr<const Strategy> strategy;
+    const size_t limit;
+    std::mutex mutex;
+    size_t running{0};
+    std::deque<Call> pending;
+  };
+
+  /**
+   * @brief Executor running the calls
+   */
+  Executor &executor_;
+
+  /**
+   * @brief Maximum number of concurrent calls per strategy
+   */
+  size_t max_in_flight_{1};
+
+  /**
+   * @brief Lane of the current strategy, guarded by `mutex_`
+   */
+  mutable std::mutex mutex_;
+  std::shared_ptr<Lane> lane_;
+};
+
+#endif  // BEHAVIORAL_PATTERNS_STRATEGY_ASYNC_CONTEXT_H_
@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "static_context.h"
+#include "strategy.h"
+
+/**
+ * @brief Benchmark harness for strategies.
+ *
+ * Every registered strategy runs on the same generated workloads: for each
+ * input size, a fixed set of pseudo-random inputs of that length (same seed
+ * for every strategy). Each case is warmed up, then timed over several
+ * repetitions. Each repetition gives the mean latency per call over the whole
+ * workload, since most calls are too short to time one by one. The columns
+ * prefixed with `rep_` (min, median, standard deviation, max) are statistics
+ * of these per-repetition means, not of individual calls: they show the
+ * spread between runs, not tail latency. `mean_ns` is the mean latency per
+ * call over every repetition, and gives the throughput.
+ *
+ * Besides one case per registered strategy, the harness measures the dispatch
+ * overhead: virtual calls through Context against std::visit through
+ * StaticContext, strategy swaps, and per-item calls against execute_batch().
+ * These use tiny strategies, so that dispatch dominates.
+ *
+ * Usage: strategy-bench [--format=csv|json] [--sizes=1,16,256,4096]
+ *                       [--inputs=1024] [--repetitions=20] [--warmup=3]
+ *                       [--cpu=N]
+ */
+
+namespace {
+
+/**
+ * @brief Sink of all results, printed to stderr at the end so that no call is
+ * optimized away.
+ */
+uint64_t gSink{0};
+
+/**
+ * @brief Tiny strategy adding the first byte of the input to the sink
+ */
+class AddFirst : public Strategy {
+ public:
+  std::string execute(const char *data = nullptr) const override {
+    gSink += static_cast<unsigned char>(data[0]);
+    return std::string();
+  }
+
+  void execute_batch(Span<const char *const> data,
+                     Span<std::string> out) const override {
+    for (size_t i = 0; i < data.size(); ++i) {
+      gSink += static_cast<unsigned char>(data[i][0]);
+      out[i].clear();
+    }
+  }
+};
+
+/**
+ * @brief Tiny strategy subtracting the first byte of the input from the sink
+ */
+class SubFirst : public Strategy {
+ public:
+  std::string execute(const char *data = nullptr) const override {
+    gSink -= static_cast<unsigned char>(data[0]);
+    return std::string();
+  }
+};
+
+/**
+ * @brief Factory of a registered strategy
+ */
+using StrategyFactory = std::function<std::unique_ptr<Strategy>()>;
+
+/**
+ * @brief Strategies under comparison. Register new implementations here.
+ */
+std::vector<std::pair<std::string, StrategyFactory>> registered_strategies() {
+  return {
+      {"ConcreteStrategyA",
+       [] { return std::make_unique<ConcreteStrategyA>(100); }},
+      {"ConcreteStrategyB",
+       [] { return std::make_unique<ConcreteStrategyB>("abcd"); }},
+      {"AddFirst", [] { return std::make_unique<AddFirst>(); }},
+  };
+}
+
+/**
+ * @brief One benchmark case: runs every input of the workload once.
+ */
+struct Case {
+  std::string name;
+  std::function<void(Span<const char *const>)> run;
+};
+
+/**
+ * @brief Cases timed by the harness
+ */
+std::vector<Case> make_cases() {
+  std::vector<Case> cases;
+
+  for (const auto &registered : registered_strategies()) {
+    auto context = std::make_shared<Context>(registered.second());
+    cases.push_back({registered.first, [context](Span<const char *const> in) {
+                       for (const char *data : in) {
+                         gSink += context->execute(data).size();
+                       }
+                     }});
+  }
+
+  {
+    auto context = std::make_shared<Context>(std::make_unique<AddFirst>());
+    cases.push_back({"dispatch/Context::execute",
+                     [context](Span<const char *const> in) {
+                       for (const char *data : in) context->execute(data);
+                     }});
+  }
+
+  {
+    auto context = std::make_shared<StaticContext<AddFirst, SubFirst>>(
+        std::in_place_type<AddFirst>);
+    cases.push_back({"dispatch/StaticContext::execute",
+                     [context](Span<const char *const> in) {
+                       for (const char *data : in) context->execute(data);
+                     }});
+  }
+
+  {
+    auto context = std::make_shared<Context>();
+    cases.push_back({"dispatch/Context::set_strategy",
+                     [context](Span<const char *const> in) {
+                       for (size_t i = 0; i < in.size(); ++i) {
+                         if (i & 1) {
+                           context->set_strategy(std::make_unique<SubFirst>());
+                         } else {
+                           context->set_strategy(std::make_unique<AddFirst>());
+                         }
+                         context->execute(in[i]);
+                       }
+                     }});
+  }
+
+  {
+    auto context = std::make_shared<StaticContext<AddFirst, SubFirst>>();
+    cases.push_back({"dispatch/StaticContext::set_strategy",
+                     [context](Span<const char *const> in) {
+                       for (size_t i = 0; i < in.size(); ++i) {
+                         if (i & 1) {
+                           context->set_strategy<SubFirst>();
+                         } else {
+                           context->set_strategy<AddFirst>();
+                         }
+                         context->execute(in[i]);
+                       }
+                     }});
+  }
+
+  {
+    auto context = std::make_shared<Context>(std::make_unique<AddFirst>());
+    auto out = std::make_shared<std::vector<std::string>>();
+    cases.push_back({"dispatch/Context::execute_batch",
+                     [context, out](Span<const char *const> in) {
+                       out->resize(in.size());
+                       context->execute_batch(in, *out);
+                     }});
+  }
+
+  return cases;
+}
+
+/**
+ * @brief Harness settings
+ */
+struct Options {
+  bool json{false};
+  std::vector<size_t> sizes{1, 16, 256, 4096};
+  size_t inputs{1024};
+  size_t repetitions{20};
+  size_t warmup{3};
+  int cpu{-1};
+};
+
+/**
+ * @brief Summary of the per-repetition mean latencies of one case on one
+ * workload, in ns per call
+ */
+struct Summary {
+  double min{0.0};
+  double median{0.0};
+  double mean{0.0};
+  double stddev{0.0};
+  double max{0.0};
+};
+
+/**
+ * @brief Summarize the mean latencies per call, one sample per repetition
+ */
+Summary summarize(std::vector<double> samples) {
+  Summary summary;
+  if (samples.empty()) return summary;
+  std::sort(samples.begin(), samples.end());
+  const size_t n = samples.size();
+  summary.min = samples.front();
+  summary.median = n % 2 ? samples[n / 2]
+                         : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+  for (const double s : samples) summary.mean += s;
+  summary.mean /= n;
+  for (const double s : samples) {
+    summary.stddev += (s - summary.mean) * (s - summary.mean);
+  }
+  summary.stddev = n > 1 ? std::sqrt(summary.stddev / (n - 1)) : 0.0;
+  summary.max = samples.back();
+  return summary;
+}
+
+/**
+ * @brief Workload: `count` pseudo-random printable inputs of `size` bytes,
+ * identical on every run.
+ */
+std::vector<std::string> make_workload(size_t size, size_t count) {
+  std::mt19937_64 random(size);
+  std::uniform_int_distribution<int> printable('!', '~');
+  std::vector<std::string> workload(count);
+  for (auto &input : workload) {
+    input.resize(size);
+    for (auto &c : input) c = static_cast<char>(printable(random));
+  }
+  return workload;
+}
+
+/**
+ * @brief Pin the calling thread to `cpu`, if supported.
+ */
+bool pin_to_cpu(int cpu) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Parse a comma-separated list of sizes
+ */
+std::vector<size_t> parse_sizes(const char *list) {
+  std::vector<size_t> sizes;
+  for (const char *p = list; *p;) {
+    char *end = nullptr;
+    const size_t size = strtoull(p, &end, 10);
+    if (end == p) return {};
+    sizes.push_back(size);
+    p = *end == ',' ? end + 1 : end;
+  }
+  return sizes;
+}
+
+/**
+ * @brief Parse the command line, returns false on invalid arguments
+ */
+bool parse(int argc, char **argv, Options *options) {
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    const char *value = strchr(arg, '=');
+    if (!value) return false;
+    const std::string key(arg, value++);
+    if (key == "--format") {
+      if (strcmp(value, "json") && strcmp(value, "csv")) return false;
+      options->json = !strcmp(value, "json");
+    } else if (key == "--sizes") {
+      options->sizes = parse_sizes(value);
+      if (options->sizes.empty()) return false;
+    } else if (key == "--inputs") {
+      options->inputs = strtoull(value, nullptr, 10);
+    } else if (key == "--repetitions") {
+      options->repetitions = strtoull(value, nullptr, 10);
+    } else if (key == "--warmup") {
+      options->warmup = strtoull(value, nullptr, 10);
+    } else if (key == "--cpu") {
+      options->cpu = atoi(value);
+    } else {
+      return false;
+    }
+  }
+  return options->inputs && options->repetitions;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parse(argc, argv, &options)) {
+    fprintf(stderr,
+            "Usage: %s [--format=csv|json] [--sizes=1,16,256,4096] "
+            "[--inputs=1024] [--repetitions=20] [--warmup=3] [--cpu=N]\n",
+            argv[0]);
+    return 1;
+  }
+  if (options.cpu >= 0 && !pin_to_cpu(options.cpu)) {
+    fprintf(stderr, "Could not pin to CPU %d, running unpinned\n",
+            options.cpu);
+  }
+
+  const auto cases = make_cases();
+  if (options.json) {
+    fprintf(stdout, "{\"cpu\":%d,\"results\":[", options.cpu);
+  } else {
+    fprintf(stdout,
+            "case,size,inputs,repetitions,rep_min_ns,rep_median_ns,mean_ns,"
+            "rep_stddev_ns,rep_max_ns,calls_per_s\n");
+  }
+
+  bool first = true;
+  for (const size_t size : options.sizes) {
+    const auto workload = make_workload(size, options.inputs);
+    std::vector<const char *> inputs;
+    for (const auto &input : workload) inputs.push_back(input.c_str());
+
+    for (const Case &c : cases) {
+      for (size_t r = 0; r < options.warmup; ++r) c.run(inputs);
+
+      std::vector<double> samples;
+      for (size_t r = 0; r < options.repetitions; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        c.run(inputs);
+        const std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        samples.push_back(elapsed.count() / inputs.size());
+      }
+
+      const Summary s = summarize(std::move(samples));
+      const double calls_per_s = s.mean > 0.0 ? 1e9 / s.mean : 0.0;
+      if (options.json) {
+        fprintf(stdout,
+                "%s{\"case\":\"%s\",\"size\":%zu,\"inputs\":%zu,"
+                "\"repetitions\":%zu,\"rep_min_ns\":%.3f,"
+                "\"rep_median_ns\":%.3f,\"mean_ns\":%.3f,"
+                "\"rep_stddev_ns\":%.3f,\"rep_max_ns\":%.3f,"
+                "\"calls_per_s\":%.0f}",
+                first ? "" : ",", c.name.c_str(), size, inputs.size(),
+                options.repetitions, s.min, s.median, s.mean, s.stddev, s.max,
+                calls_per_s);
+      } else {
+        fprintf(stdout, "%s,%zu,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%.0f\n",
+                c.name.c_str(), size, inputs.size(), options.repetitions,
+                s.min, s.median, s.mean, s.stddev, s.max, calls_per_s);
+      }
+      first = false;
+    }
+  }
+
+  if (options.json) fprintf(stdout, "]}\n");
+  fprintf(stderr, "(sink %llu)\n", static_cast<unsigned long long>(gSink));
+  return 0;
+}
@@ -0,0 +1,138 @@
+#ifndef BEHAVIORAL_PATTERNS_STRATEGY_CONCURRENT_CONTEXT_H_
+#define BEHAVIORAL_PATTERNS_STRATEGY_CONCURRENT_CONTEXT_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "strategy.h"
+
+/**
+ * @brief ConcurrentContext is a Context whose strategy can be swapped while
+ * other threads are executing it.
+ *
+ * Readers never take a lock. They register in one of two reader counters
+ * (picked by the current epoch), load the published strategy and execute it.
+ * set_strategy() publishes the new strategy atomically, then waits for a grace
+ * period (each counter observed empty once) before freeing the old strategy,
+ * so in-flight calls always finish on a live object. Only writers are
+ * serialized with each other.
+ */
+class ConcurrentContext {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param strategy Strategy
+   */
+  explicit ConcurrentContext(std::unique_ptr<Strategy> &&strategy = nullptr)
+      : strategy_(strategy.release()){};
+
+  ConcurrentContext(const ConcurrentContext &) = delete;
+  ConcurrentContext(ConcurrentContext &&) = delete;
+  ConcurrentContext operator=(const ConcurrentContext &) = delete;
+  ConcurrentContext operator=(ConcurrentContext &&) = delete;
+
+  /**
+   * @brief Destructor
+   *
+   * @note No reader may be running when the context is destroyed.
+   */
+  ~ConcurrentContext() { delete strategy_.load(); }
+
+  /**
+   * @brief Publish a new strategy. Returns once no reader can still be using
+   * the previous one, which is then freed.
+   */
+  void set_strategy(std::unique_ptr<Strategy> &&strategy) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    std::unique_ptr<Strategy> old(strategy_.exchange(strategy.release()));
+    synchronize();
+  }
+
+  /**
+   * @brief Execute the published strategy without locking.
+   *
+   * @param data Data
+   */
+  void do_something(const char *data = nullptr) const {
+    ReadGuard guard(this);
+    const Strategy *strategy = strategy_.load();
+    if (!strategy) {
+      fprintf(stdout, "ConcurrentContext: Strategy isn't set\n");
+      return;
+    }
+
+    fprintf(stdout, "ConcurrentContext: Execute strategy:\n");
+    fprintf(stdout, "%s\n", strategy->execute(data).c_str());
+  }
+
+ private:
+  /**
+   * @brief Registers a reader in the counter of the current epoch for the
+   * lifetime of the guard.
+   */
+  class ReadGuard {
+   public:
+    explicit ReadGuard(const ConcurrentContext *context)
+        : counter_(context->readers_[context->epoch_.load() & 1u].count) {
+      counter_.fetch_add(1);
+    }
+    ReadGuard(const ReadGuard &) = delete;
+    ReadGuard operator=(const ReadGuard &) = delete;
+    ~ReadGuard() { counter_.fetch_sub(1); }
+
+   private:
+    std::atomic<size_t> &counter_;
+  };
+
+  /**
+   * @brief Wait until every reader that may have loaded the old strategy is
+   * done.
+   *
+   * @note Flipping the epoch sends new readers to the other counter, so the
+   * counter being drained only holds readers that started before the flip.
+   * Both counters are drained once, which covers readers that read the epoch
+   * before a flip but registered after it.
+   */
+  void synchronize() {
+    for (int i = 0; i < 2; ++i) {
+      const unsigned epoch = epoch_.fetch_xor(1u) & 1u;
+      while (readers_[epoch].count.load() != 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  /**
+   * @brief Reader counter, padded to its own cache line.
+   */
+  struct alignas(64) ReaderCount {
+    std::atomic<size_t> count{0};
+  };
+
+  /**
+   * @brief Reader counters, one per epoch parity
+   */
+  mutable ReaderCount readers_[2];
+
+  /**
+   * @brief Current epoch, its lowest bit selects the reader counter
+   */
+  std::atomic<unsigned> epoch_{0};
+
+  /**
+   * @brief Published strategy
+   */
+  std::atomic<Strategy *> strategy_;
+
+  /**
+   * @brief Serializes writers
+   */
+  std::mutex writer_mutex_;
+};
+
+#endif  // BEHAVIORAL_PATTERNS_STRATEGY_CONCURRENT_CONTEXT_H_
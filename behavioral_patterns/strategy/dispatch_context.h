@@ -0,0 +1,149 @@
+#ifndef BEHAVIORAL_PATTERNS_STRATEGY_DISPATCH_CONTEXT_H_
+#define BEHAVIORAL_PATTERNS_STRATEGY_DISPATCH_CONTEXT_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "strategy.h"
+
+/**
+ * @brief DispatchContext picks the strategy from the length of the input.
+ *
+ * Strategies are added in tiers, from the one meant for the smallest inputs to
+ * the one meant for the largest (e.g. scalar, SIMD, parallel). Tier `i` serves
+ * inputs shorter than the `i`-th crossover threshold. Thresholds are either set
+ * by hand or measured by calibrate().
+ */
+class DispatchContext {
+ public:
+  /**
+   * @brief Constructor
+   */
+  DispatchContext() = default;
+
+  DispatchContext(const DispatchContext &) = delete;
+  DispatchContext(DispatchContext &&) = delete;
+  DispatchContext operator=(const DispatchContext &) = delete;
+  DispatchContext operator=(DispatchContext &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~DispatchContext() = default;
+
+  /**
+   * @brief Add the strategy for the next larger input tier. Until calibrated,
+   * the new tier is never selected.
+   */
+  void add_strategy(std::unique_ptr<Strategy> &&strategy) {
+    if (!strategies_.empty()) {
+      thresholds_.push_back(std::numeric_limits<size_t>::max());
+    }
+    strategies_.push_back(std::move(strategy));
+  }
+
+  /**
+   * @brief Set the crossover thresholds by hand, one per tier after the first.
+   */
+  void set_thresholds(std::vector<size_t> thresholds) {
+    if (thresholds.size() != thresholds_.size() ||
+        !std::is_sorted(thresholds.begin(), thresholds.end())) {
+      fprintf(stdout, "DispatchContext: Invalid thresholds\n");
+      return;
+    }
+    thresholds_ = std::move(thresholds);
+  }
+
+  /**
+   * @brief Measure every tier on generated inputs of length 1, 2, 4, ... up to
+   * `max_length`, and place each crossover at the first length where a larger
+   * tier becomes the fastest.
+   *
+   * @param max_length Longest calibration input
+   * @param repetitions Runs per tier and length, the fastest one is kept
+   */
+  void calibrate(size_t max_length, size_t repetitions = 3) {
+    std::vector<size_t> thresholds(thresholds_.size(),
+                                   std::numeric_limits<size_t>::max());
+    size_t tier = 0;
+    for (size_t length = 1; length && length <= max_length; length <<= 1) {
+      const std::string input(length, 'x');
+      const size_t fastest = measure_fastest(input.c_str(), repetitions);
+      // Tiers only go up with the input length.
+      for (; tier < fastest; ++tier) {
+        thresholds[tier] = length;
+      }
+    }
+    thresholds_ = std::move(thresholds);
+  }
+
+  /**
+   * @brief Crossover thresholds
+   */
+  const std::vector<size_t> &thresholds() const { return thresholds_; }
+
+  /**
+   * @brief Execute the strategy of the tier `data` falls in.
+   *
+   * @param data Data
+   */
+  void do_something(const char *data = nullptr) const {
+    if (strategies_.empty()) {
+      fprintf(stdout, "DispatchContext: Strategy isn't set\n");
+      return;
+    }
+
+    const size_t tier = tier_of(data ? strlen(data) : 0);
+    fprintf(stdout, "DispatchContext: Execute strategy of tier %zu:\n", tier);
+    fprintf(stdout, "%s\n", strategies_[tier]->execute(data).c_str());
+  }
+
+ private:
+  /**
+   * @brief Tier serving inputs of `length`
+   */
+  size_t tier_of(size_t length) const {
+    return std::upper_bound(thresholds_.begin(), thresholds_.end(), length) -
+           thresholds_.begin();
+  }
+
+  /**
+   * @brief Index of the fastest tier on `data`
+   */
+  size_t measure_fastest(const char *data, size_t repetitions) const {
+    size_t fastest = 0;
+    auto fastest_time = std::chrono::steady_clock::duration::max();
+    for (size_t i = 0; i < strategies_.size(); ++i) {
+      auto best = std::chrono::steady_clock::duration::max();
+      for (size_t r = 0; r < std::max<size_t>(repetitions, 1); ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        strategies_[i]->execute(data);
+        best = std::min(best, std::chrono::steady_clock::now() - start);
+      }
+      if (best < fastest_time) {
+        fastest = i;
+        fastest_time = best;
+      }
+    }
+    return fastest;
+  }
+
+  /**
+   * @brief Strategies, one per tier
+   */
+  std::vector<std::unique_ptr<Strategy>> strategies_;
+
+  /**
+   * @brief Crossover thresholds, tier `i + 1` starts at `thresholds_[i]`
+   */
+  std::vector<size_t> thresholds_;
+};
+
+#endif  // BEHAVIORAL_PATTERNS_STRATEGY_DISPATCH_CONTEXT_H_
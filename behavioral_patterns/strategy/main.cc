@@ -1,5 +1,23 @@
+#include <chrono>
 #include <cstdio>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <limits>
 #include <memory>
+#include <string>
+#include <thread>
+
+#include "adaptive_context.h"
+#include "async_context.h"
+#include "concurrent_context.h"
+#include "dispatch_context.h"
+#include "executor.h"
+#include "memoized_strategy.h"
+#include "profiled_context.h"
+#include "race_context.h"
+#include "static_context.h"
+#include "strategy.h"
 
 /**
  * @brief Strategy is a behavioral design pattern that lets you define a family
@@ -57,178 +75,193 @@
 //////////////////////////////////////////////////////////////////////
 
 /**
- * @brief Strategy
- */
-class Strategy {
- public:
-  /**
-   * @brief Default constructor
-   */
-  Strategy() = default;
-
-  Strategy(const Strategy &) = delete;
-  Strategy(Strategy &&) = delete;
-
-  /**
-   * @brief Destructor
-   */
-  virtual ~Strategy() = default;
-
-  /**
-   * @brief Execution
-   *
-   * @param data
-   * @return std::string
-   */
-  virtual void execute(const char *data = nullptr) const = 0;
-};
-
-/**
- * @brief Context defines the interface of interest to clients.
+ * @brief Strategy taking a fixed time plus a time per input byte, well above
+ * the noise of the clock, so that the demos measuring strategies always pick
+ * the same one.
  */
-class Context {
+class PacedStrategy final : public Strategy {
  public:
   /**
    * @brief Constructor
    *
-   * @param strategy Strategy
+   * @param strategy Strategy producing the result
+   * @param fixed Time taken by every call
+   * @param per_byte Time taken per input byte
    */
-  explicit Context(std::unique_ptr<Strategy> &&strategy = nullptr)
-      : strategy_(std::move(strategy)){};
+  PacedStrategy(std::unique_ptr<Strategy> &&strategy,
+                std::chrono::microseconds fixed,
+                std::chrono::microseconds per_byte)
+      : strategy_(std::move(strategy)), fixed_(fixed), per_byte_(per_byte) {}
 
-  Context(const Context &) = delete;
-  Context(Context &&) = delete;
-  Context operator=(const Context &) = delete;
-  Context operator=(Context &&) = delete;
+  std::string execute(const char *data = nullptr) const override {
+    const size_t length = data ? strlen(data) : 0;
+    std::this_thread::sleep_for(fixed_ + per_byte_ * length);
+    return strategy_->execute(data);
+  }
 
-  /**
-   * @brief Destructor
-   */
-  ~Context() = default;
+ private:
+  std::unique_ptr<Strategy> strategy_;
+  std::chrono::microseconds fixed_;
+  std::chrono::microseconds per_byte_;
+};
 
-  /**
-   * @brief Strategy setter to set trategy object at runtime.
-   */
-  void set_strategy(std::unique_ptr<Strategy> &&strategy) {
-    strategy_ = std::move(strategy);
+void client_run() {
+  {
+    Context context(nullptr);
+    fprintf(stdout, "Client: Running without Strategy.\n");
+    context.do_something();
+    fprintf(stdout, "\n");
   }
 
-  /**
-   * The Context delegates some work to the Strategy object instead of
-   * implementing +multiple versions of the algorithm on its own.
-   */
-  void do_something() const {
-    if (!strategy_) {
-      fprintf(stdout, "Context: Strategy isn't set\n");
-      return;
-    }
+  {
+    Context context(std::make_unique<ConcreteStrategyA>(100));
+    fprintf(stdout, "Client: Running using Strategy A.\n");
+    context.do_something();
+    fprintf(stdout, "\n");
 
-    fprintf(stdout, "Context: Execute strategy:\n");
-    strategy_->execute();
+    fprintf(stdout, "Client: Running using Strategy B.\n");
+    context.set_strategy(std::make_unique<ConcreteStrategyB>("abcd"));
+    context.do_something();
     fprintf(stdout, "\n");
   }
 
- private:
-  /**
-   * @brief strategy
-   *
-   * The Context maintains a reference to one of the Strategy objects. The
-   * Context does not know the concrete class of a strategy. It should work with
-   * all strategies via the Strategy interface.
-   */
-  std::unique_ptr<Strategy> strategy_;
-};
+  {
+    ConcurrentContext context(std::make_unique<ConcreteStrategyA>(100));
+    fprintf(stdout, "Client: Swapping to Strategy B while running.\n");
+    std::thread writer([&context] {
+      context.set_strategy(std::make_unique<ConcreteStrategyB>("abcd"));
+    });
+    for (int i = 0; i < 3; ++i) {
+      context.do_something();
+    }
+    writer.join();
+    context.do_something();
+    fprintf(stdout, "\n");
+  }
+  {
+    AdaptiveContext context(4);
+    context.add_strategy(std::make_unique<ConcreteStrategyA>(100));
+    context.add_strategy(std::make_unique<PacedStrategy>(
+        std::make_unique<ConcreteStrategyB>("abcd"),
+        std::chrono::milliseconds(2), std::chrono::microseconds(0)));
+    fprintf(stdout, "Client: Letting the context pick the fastest strategy.\n");
+    for (int i = 0; i < 6; ++i) {
+      context.do_something("route");
+    }
+    fprintf(stdout, "Client: Fastest strategy for this input: %zu\n",
+            context.fastest("route"));
+    fprintf(stdout, "\n");
+  }
 
-/**
- * @brief ConcreteStrategyA inherites from Strategy
- */
-class ConcreteStrategyA : public Strategy {
- public:
-  ConcreteStrategyA() = delete;
-  ConcreteStrategyA(const ConcreteStrategyA &) = delete;
-  ConcreteStrategyA(ConcreteStrategyA &&) = delete;
-  ConcreteStrategyA operator=(const ConcreteStrategyA &) = delete;
-  ConcreteStrategyA operator=(ConcreteStrategyA &&) = delete;
+  {
+    // Tier 0 costs 100us per byte and tier 1 a flat 1.2ms: the crossover is
+    // between 8 and 16 bytes.
+    DispatchContext context;
+    context.add_strategy(std::make_unique<PacedStrategy>(
+        std::make_unique<ConcreteStrategyA>(100), std::chrono::microseconds(0),
+        std::chrono::microseconds(100)));
+    context.add_strategy(std::make_unique<PacedStrategy>(
+        std::make_unique<ConcreteStrategyB>("abcd"),
+        std::chrono::microseconds(1200), std::chrono::microseconds(0)));
+    fprintf(stdout, "Client: Calibrating the crossover at startup.\n");
+    context.calibrate(64, 3);
+    const size_t crossover = context.thresholds().front();
+    if (crossover == std::numeric_limits<size_t>::max()) {
+      fprintf(stdout, "Client: Tier 1 is never faster up to 64 bytes\n");
+    } else {
+      fprintf(stdout, "Client: Tier 1 from %zu bytes\n", crossover);
+    }
+    fprintf(stdout, "\n");
 
-  /**
-   * @brief Constructor
-   */
-  explicit ConcreteStrategyA(size_t number) : internal_number_(number){};
+    fprintf(stdout, "Client: Dispatching on the input length (calibrated).\n");
+    context.do_something("short");
+    context.do_something("a much longer input, past any crossover found by "
+                         "calibrating up to sixty-four bytes");
+    fprintf(stdout, "\n");
 
-  /**
-   * @brief Execute
-   *
-   * @param data Data
-   */
-  void execute(const char *data = nullptr) const override {
-    fprintf(stdout, "Doing something using Strategy A - Internal data \"%zu\"",
-            internal_number_);
+    fprintf(stdout, "Client: Dispatching on the input length (by hand).\n");
+    context.set_thresholds({8});
+    context.do_something("short");
+    context.do_something("a much longer input");
+    fprintf(stdout, "\n");
   }
 
- private:
-  /**
-   * @brief Internal number
-   */
-  size_t internal_number_{0};
-};
-
-/**
- * @brief ConcreteStrategyB inherites from Strategy
- */
-class ConcreteStrategyB : public Strategy {
- public:
-  ConcreteStrategyB() = delete;
-  ConcreteStrategyB(const ConcreteStrategyB &) = delete;
-  ConcreteStrategyB(ConcreteStrategyB &&) = delete;
-  ConcreteStrategyB operator=(const ConcreteStrategyB &) = delete;
-  ConcreteStrategyB operator=(ConcreteStrategyB &&) = delete;
-
-  /**
-   * @brief Constructor
-   *
-   * @param string String
-   */
-  explicit ConcreteStrategyB(const char *string) : internal_char_(string){};
+  {
+    StaticContext<ConcreteStrategyA, ConcreteStrategyB> context(
+        std::in_place_type<ConcreteStrategyA>, 100);
+    fprintf(stdout, "Client: Running using Strategy A without a vtable.\n");
+    context.do_something();
+    fprintf(stdout, "\n");
 
-  /**
-   * @brief Destructor
-   */
-  ~ConcreteStrategyB() = default;
+    fprintf(stdout, "Client: Swapping to Strategy B in place.\n");
+    context.set_strategy<ConcreteStrategyB>("abcd");
+    context.do_something();
+    fprintf(stdout, "\n");
+  }
 
-  /**
-   * @brief Execute
-   *
-   * @param data Data
-   */
-  void execute(const char *data = nullptr) const override {
-    fprintf(stdout, "Doing something using Strategy B - Internal data \"%s\"",
-            internal_char_);
+  {
+    Context context(std::make_unique<ConcreteStrategyA>(100));
+    const char *const routes[] = {"road", "transit", "walking"};
+    std::string results[3];
+    fprintf(stdout, "Client: Running Strategy A on a batch.\n");
+    context.execute_batch(routes, results);
+    for (size_t i = 0; i < 3; ++i) {
+      fprintf(stdout, "%s: %s\n", routes[i], results[i].c_str());
+    }
+    fprintf(stdout, "\n");
   }
 
- private:
-  /**
-   * @brief Internal string
-   */
-  const char *internal_char_{nullptr};
-};
+  {
+    Executor executor(2);
+    RaceContext context(executor);
+    context.add_strategy(std::make_unique<ConcreteStrategyA>(100));
+    context.add_strategy(std::make_unique<ConcreteStrategyB>("abcd"));
+    fprintf(stdout, "Client: Racing Strategy A against Strategy B.\n");
+    context.do_something("route");
+    fprintf(stdout, "\n");
+  }
 
-void client_run() {
   {
-    Context context(nullptr);
-    fprintf(stdout, "Client: Running without Strategy.\n");
+    auto memoized = std::make_unique<MemoizedStrategy>(
+        std::make_unique<ConcreteStrategyA>(100));
+    const MemoizedStrategy *cache = memoized.get();
+    Context context(std::move(memoized));
+    fprintf(stdout, "Client: Running memoized Strategy A twice.\n");
+    context.do_something();
     context.do_something();
+    fprintf(stdout, "Client: Cache hits %zu, misses %zu\n", cache->hits(),
+            cache->misses());
     fprintf(stdout, "\n");
   }
 
   {
-    Context context(std::make_unique<ConcreteStrategyA>(100));
-    fprintf(stdout, "Client: Running using Strategy A.\n");
+    ProfiledContext context(std::make_unique<ConcreteStrategyA>(100), "A");
+    fprintf(stdout, "Client: Profiling Strategy A, B, then A again.\n");
+    context.do_something();
+    context.set_strategy(std::make_unique<ConcreteStrategyB>("abcd"), "B");
     context.do_something();
+    context.do_something();
+    context.set_strategy(std::make_unique<ConcreteStrategyA>(100), "A");
+    context.do_something();
+    fprintf(stdout, "Client: Profiles %s\n", context.to_json().c_str());
     fprintf(stdout, "\n");
+  }
+
+  {
+    Executor executor(2);
+    AsyncContext context(executor, std::make_unique<ConcreteStrategyA>(100));
+    fprintf(stdout, "Client: Running Strategy A asynchronously.\n");
+    auto road = context.execute_async("road");
+    auto walking = context.execute_async("walking");
+    fprintf(stdout, "Client: Doing other work while the strategy runs.\n");
+    fprintf(stdout, "road: %s\n", road.get().c_str());
+    fprintf(stdout, "walking: %s\n", walking.get().c_str());
 
-    fprintf(stdout, "Client: Running using Strategy B.\n");
     context.set_strategy(std::make_unique<ConcreteStrategyB>("abcd"));
-    context.do_something();
+    context.execute_async(
+        "transit", [](std::string result, std::exception_ptr error) {
+          if (!error) fprintf(stdout, "transit: %s\n", result.c_str());
+        });
   }
 }
 
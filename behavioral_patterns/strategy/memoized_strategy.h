@@ -0,0 +1,246 @@
+#ifndef BEHAVIORAL_PATTERNS_STRATEGY_MEMOIZED_STRATEGY_H_
+#define BEHAVIORAL_PATTERNS_STRATEGY_MEMOIZED_STRATEGY_H_
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "stop_token.h"
+#include "strategy.h"
+
+/**
+ * @brief MemoizedStrategy wraps any Strategy and caches its results, keyed on
+ * the input.
+ *
+ * Being a Strategy itself, it plugs into any Context without changes to the
+ * wrapped strategy. The cache is split in shards selected by the input hash,
+ * each with its own lock and least-recently-used eviction, so that concurrent
+ * callers rarely contend. Lookups compare the cached inputs with the caller's
+ * input in place, the input is only copied when a result is inserted. The
+ * wrapped strategy runs outside of any lock: two concurrent misses on the same
+ * input may both compute it.
+ *
+ * @note Only deterministic strategies (same input, same result) should be
+ * memoized.
+ */
+class MemoizedStrategy : public Strategy {
+ public:
+  MemoizedStrategy() = delete;
+  MemoizedStrategy(const MemoizedStrategy &) = delete;
+  MemoizedStrategy(MemoizedStrategy &&) = delete;
+  MemoizedStrategy operator=(const MemoizedStrategy &) = delete;
+  MemoizedStrategy operator=(MemoizedStrategy &&) = delete;
+
+  /**
+   * @brief Constructor
+   *
+   * @param strategy Wrapped strategy
+   * @param capacity Maximum number of cached results, split between the shards
+   * (each shard holds at most its share, even while others have room)
+   * @param shards Number of independently locked shards
+   */
+  explicit MemoizedStrategy(std::unique_ptr<Strategy> &&strategy,
+                            size_t capacity = 1024, size_t shards = 16)
+      : strategy_(std::move(strategy)), shards_(shards ? shards : 1) {
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      shards_[i].capacity = capacity / shards_.size() +
+                            (i < capacity % shards_.size() ? 1 : 0);
+    }
+  }
+
+  /**
+   * @brief Destructor
+   */
+  ~MemoizedStrategy() = default;
+
+  /**
+   * @brief Execute, from the cache when the result of `data` is known.
+   *
+   * @param data Data
+   * @return std::string
+   */
+  std::string execute(const char *data = nullptr) const override {
+    const KeyView key(data);
+    const size_t hash = key.hash();
+    Shard &shard = shards_[hash % shards_.size()];
+
+    std::string result;
+    if (shard.find(key, hash, &result)) {
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return result;
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    result = strategy_->execute(data);
+    shard.insert(key, hash, result);
+    return result;
+  }
+
+  /**
+   * @brief Batch execution: hits are answered from the cache, the misses are
+   * forwarded to the wrapped strategy as one batch.
+   *
+   * @param data Inputs
+   * @param out Results, at least as many as inputs
+   */
+  void execute_batch(Span<const char *const> data,
+                     Span<std::string> out) const override {
+    std::vector<size_t> missed;
+    std::vector<const char *> missed_data;
+    for (size_t i = 0; i < data.size(); ++i) {
+      const KeyView key(data[i]);
+      const size_t hash = key.hash();
+      if (shards_[hash % shards_.size()].find(key, hash, &out[i])) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        missed.push_back(i);
+        missed_data.push_back(data[i]);
+      }
+    }
+    if (missed.empty()) return;
+
+    misses_.fetch_add(missed.size(), std::memory_order_relaxed);
+    std::vector<std::string> results(missed.size());
+    strategy_->execute_batch(missed_data, results);
+    for (size_t m = 0; m < missed.size(); ++m) {
+      const KeyView key(missed_data[m]);
+      const size_t hash = key.hash();
+      shards_[hash % shards_.size()].insert(key, hash, results[m]);
+      out[missed[m]] = std::move(results[m]);
+    }
+  }
+
+  /**
+   * @brief Cancellable execution, bypasses the cache since a cancelled result
+   * must not be kept.
+   */
+  std::string execute_cancellable(const char *data,
+                                  const StopToken &stop) const override {
+    return strategy_->execute_cancellable(data, stop);
+  }
+
+  /**
+   * @brief Number of calls answered from the cache
+   */
+  size_t hits() const { return hits_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Number of calls forwarded to the wrapped strategy
+   */
+  size_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+ private:
+  /**
+   * @brief Input being looked up, viewed in place (a null input is its own
+   * key)
+   */
+  struct KeyView {
+    explicit KeyView(const char *data)
+        : null(!data), input(data ? data : "") {}
+
+    size_t hash() const {
+      return std::hash<std::string_view>()(input) ^ static_cast<size_t>(null);
+    }
+
+    bool null;
+    std::string_view input;
+  };
+
+  /**
+   * @brief Cached key, a copy of the input
+   */
+  struct Key {
+    explicit Key(const KeyView &view)
+        : null(view.null), input(view.input) {}
+
+    bool operator==(const KeyView &view) const {
+      return null == view.null && input == view.input;
+    }
+
+    bool null;
+    std::string input;
+  };
+
+  /**
+   * @brief One shard: entries from most to least recently used, indexed by hash
+   */
+  struct Shard {
+    struct Entry {
+      Key key;
+      size_t hash;
+      std::string result;
+    };
+    using Iterator = std::list<Entry>::iterator;
+
+    bool find(const KeyView &key, size_t hash, std::string *result) {
+      std::lock_guard<std::mutex> lock(mutex);
+      const auto it = lookup(key, hash);
+      if (it == index.end()) return false;
+      entries.splice(entries.begin(), entries, it->second);
+      *result = it->second->result;
+      return true;
+    }
+
+    void insert(const KeyView &key, size_t hash, const std::string &result) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!capacity || lookup(key, hash) != index.end()) return;
+      if (entries.size() >= capacity) {
+        evict();
+      }
+      entries.push_front(Entry{Key(key), hash, result});
+      index.emplace(hash, entries.begin());
+    }
+
+    std::unordered_multimap<size_t, Iterator>::iterator lookup(
+        const KeyView &key, size_t hash) {
+      auto range = index.equal_range(hash);
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->key == key) return it;
+      }
+      return index.end();
+    }
+
+    void evict() {
+      const Iterator last = std::prev(entries.end());
+      auto range = index.equal_range(last->hash);
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == last) {
+          index.erase(it);
+          break;
+        }
+      }
+      entries.erase(last);
+    }
+
+    std::mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_multimap<size_t, Iterator> index;
+    size_t capacity{0};
+  };
+
+  /**
+   * @brief Wrapped strategy
+   */
+  std::unique_ptr<Strategy> strategy_;
+
+  /**
+   * @brief Cache shards
+   */
+  mutable std::vector<Shard> shards_;
+
+  /**
+   * @brief Hit and miss counters
+   */
+  mutable std::atomic<size_t> hits_{0};
+  mutable std::atomic<size_t> misses_{0};
+};
+
+#endif  // BEHAVIORAL_PATTERNS_STRATEGY_MEMOIZED_STRATEGY_H_
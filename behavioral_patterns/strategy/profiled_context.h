@@ -0,0 +1,218 @@
+#ifndef BEHAVIORAL_PATTERNS_STRATEGY_PROFILED_CONTEXT_H_
+#define BEHAVIORAL_PATTERNS_STRATEGY_PROFILED_CONTEXT_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "latency_histogram.h"
+#include "strategy.h"
+
+/**
+ * @brief ProfiledContext is a Context that records, for every strategy it has
+ * run, the number of calls and a latency histogram, along with the number of
+ * strategy swaps.
+ *
+ * Each strategy name gets a profile, a LatencyHistogram which a strategy set
+ * again under the same name keeps adding to. Queries may run from any thread
+ * while calls are in flight.
+ *
+ * @note As with Context, set_strategy() must not race with calls.
+ */
+class ProfiledContext {
+ public:
+  /**
+   * @brief Number of latency buckets, see LatencyHistogram
+   */
+  static constexpr size_t cBuckets{LatencyHistogram::cBuckets};
+
+  /**
+   * @brief Profile of one strategy, as returned by queries
+   */
+  struct Profile : LatencyHistogram::Snapshot {
+    std::string name;
+  };
+
+  /**
+   * @brief Constructor
+   *
+   * @param strategy Strategy
+   * @param name Strategy name, as reported in the profiles
+   */
+  explicit ProfiledContext(std::unique_ptr<Strategy> &&strategy = nullptr,
+                           std::string name = "strategy") {
+    if (strategy) install(std::move(strategy), std::move(name));
+  }
+
+  ProfiledContext(const ProfiledContext &) = delete;
+  ProfiledContext(ProfiledContext &&) = delete;
+  ProfiledContext operator=(const ProfiledContext &) = delete;
+  ProfiledContext operator=(ProfiledContext &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~ProfiledContext() = default;
+
+  /**
+   * @brief Strategy setter, records calls under the profile of `name`, started
+   * if `name` is new.
+   */
+  void set_strategy(std::unique_ptr<Strategy> &&strategy, std::string name) {
+    install(std::move(strategy), std::move(name));
+    swaps_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Run the strategy on `data` and record the call.
+   *
+   * @param data Data
+   * @return std::string
+   */
+  std::string execute(const char *data = nullptr) const {
+    if (!strategy_) return std::string();
+
+    const auto start = std::chrono::steady_clock::now();
+    std::string result = strategy_->execute(data);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    counters_->record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    return result;
+  }
+
+  /**
+   * @brief The Context delegates some work to the Strategy object.
+   */
+  void do_something() const {
+    if (!strategy_) {
+      fprintf(stdout, "ProfiledContext: Strategy isn't set\n");
+      return;
+    }
+
+    fprintf(stdout, "ProfiledContext: Execute strategy:\n");
+    fprintf(stdout, "%s\n", execute().c_str());
+  }
+
+  /**
+   * @brief Number of strategy swaps since construction
+   */
+  size_t swaps() const { return swaps_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Snapshot of the profiles of every strategy name set so far, oldest
+   * first
+   */
+  std::vector<Profile> profiles() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Profile> profiles;
+    for (const auto &entry : profiles_) {
+      Profile profile;
+      static_cast<LatencyHistogram::Snapshot &>(profile) =
+          entry.second->snapshot();
+      profile.name = entry.first;
+      profiles.push_back(std::move(profile));
+    }
+    return profiles;
+  }
+
+  /**
+   * @brief Profiles as a JSON document:
+   * {"swaps":N,"strategies":[{"name":..,"calls":..,"total_ns":..,
+   *  "histogram":[{"le_ns":..,"count":..},...]},...]}
+   * Only non-empty histogram buckets are listed, `le_ns` is the exclusive
+   * upper bound of the bucket (null for the open last one).
+   */
+  std::string to_json() const {
+    std::string json = "{\"swaps\":" + std::to_string(swaps()) +
+                       ",\"strategies\":[";
+    const auto all = profiles();
+    for (size_t i = 0; i < all.size(); ++i) {
+      const Profile &profile = all[i];
+      if (i) json += ',';
+      json += "{\"name\":\"" + escape(profile.name) +
+              "\",\"calls\":" + std::to_string(profile.calls) +
+              ",\"total_ns\":" + std::to_string(profile.total_ns) +
+              ",\"histogram\":[";
+      bool first = true;
+      for (size_t b = 0; b < cBuckets; ++b) {
+        if (!profile.histogram[b]) continue;
+        if (!first) json += ',';
+        first = false;
+        json += "{\"le_ns\":" +
+                (b + 1 < cBuckets ? std::to_string(uint64_t{1} << b)
+                                  : std::string("null")) +
+                ",\"count\":" + std::to_string(profile.histogram[b]) + "}";
+      }
+      json += "]}";
+    }
+    return json + "]}";
+  }
+
+ private:
+  /**
+   * @brief Make `strategy` current, with the profile of `name`
+   */
+  void install(std::unique_ptr<Strategy> &&strategy, std::string name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(
+        profiles_.begin(), profiles_.end(),
+        [&name](const auto &entry) { return entry.first == name; });
+    if (it == profiles_.end()) {
+      profiles_.emplace_back(std::move(name),
+                             std::make_unique<LatencyHistogram>());
+      it = std::prev(profiles_.end());
+    }
+    strategy_ = std::move(strategy);
+    counters_ = it->second.get();
+  }
+
+  /**
+   * @brief Escape a string for a JSON string literal
+   */
+  static std::string escape(const std::string &string) {
+    std::string escaped;
+    for (const char c : string) {
+      if (c == '"' || c == '\\') {
+        escaped += '\\';
+        escaped += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char code[8];
+        snprintf(code, sizeof(code), "\\u%04x", c);
+        escaped += code;
+      } else {
+        escaped += c;
+      }
+    }
+    return escaped;
+  }
+
+  /**
+   * @brief Current strategy and its counters
+   */
+  std::unique_ptr<Strategy> strategy_;
+  LatencyHistogram *counters_{nullptr};
+
+  /**
+   * @brief Profiles of every strategy name set so far, in the order they were
+   * first set, guarded by `mutex_`
+   */
+  mutable std::mutex mutex_;
+  std::vector<std::pair<std::string, std::unique_ptr<LatencyHistogram>>>
+      profiles_;
+
+  /**
+   * @brief Number of swaps
+   */
+  std::atomic<size_t> swaps_{0};
+};
+
+#endif  // BEHAVIORAL_PATTERNS_STRATEGY_PROFILED_CONTEXT_H_
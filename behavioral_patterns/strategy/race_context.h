@@ -0,0 +1,178 @@
+#ifndef BEHAVIORAL_PATTERNS_STRATEGY_RACE_CONTEXT_H_
+#define BEHAVIORAL_PATTERNS_STRATEGY_RACE_CONTEXT_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "executor.h"
+#include "stop_token.h"
+#include "strategy.h"
+
+/**
+ * @brief RaceContext runs all of its strategies concurrently on the same input
+ * and returns the first result to finish.
+ *
+ * Each strategy runs as an Executor task through execute_cancellable(). Once
+ * a result is in, the other strategies are asked to stop through their token
+ * and the caller returns right away, without waiting for them. The strategies,
+ * the race state and a copy of the input are shared with the tasks, so losers
+ * may outlive both the call and the context.
+ *
+ * @note The executor must outlive the context and its losing calls. With
+ * fewer executor threads than strategies, some strategies only start once
+ * others finish, and those still queued when a result is in never start.
+ * execute() blocks on tasks of the executor, so calling it from one of the
+ * executor's own tasks can deadlock once every worker waits that way.
+ */
+class RaceContext {
+ public:
+  RaceContext() = delete;
+
+  /**
+   * @brief Constructor
+   *
+   * @param executor Executor running the strategies
+   */
+  explicit RaceContext(Executor &executor) : executor_(executor){};
+
+  RaceContext(const RaceContext &) = delete;
+  RaceContext(RaceContext &&) = delete;
+  RaceContext operator=(const RaceContext &) = delete;
+  RaceContext operator=(RaceContext &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~RaceContext() = default;
+
+  /**
+   * @brief Add a strategy to the race
+   */
+  void add_strategy(std::unique_ptr<Strategy> &&strategy) {
+    strategies_.emplace_back(std::move(strategy));
+  }
+
+  /**
+   * @brief Race the strategies on `data`.
+   *
+   * @note If every strategy throws, the last exception is rethrown.
+   *
+   * @param data Data, copied
+   * @param winner Receives the index of the winning strategy, if not null
+   * @return std::string
+   */
+  std::string execute(const char *data = nullptr,
+                      size_t *winner = nullptr) const {
+    if (strategies_.empty()) {
+      throw std::logic_error("RaceContext: Strategy isn't set");
+    }
+
+    auto race = std::make_shared<Race>();
+    race->has_input = data != nullptr;
+    race->input = data ? data : "";
+    race->pending = strategies_.size();
+    for (size_t i = 0; i < strategies_.size(); ++i) {
+      executor_.submit([race, strategy = strategies_[i], i] {
+        race->run(*strategy, i);
+      });
+    }
+
+    std::unique_lock<std::mutex> lock(race->mutex);
+    race->done.wait(lock, [&race] { return race->finished; });
+    if (race->winner == cNoWinner) {
+      std::rethrow_exception(race->error);
+    }
+    if (winner) *winner = race->winner;
+    return std::move(race->result);
+  }
+
+  /**
+   * @brief The Context delegates some work to the fastest Strategy.
+   *
+   * @param data Data
+   */
+  void do_something(const char *data = nullptr) const {
+    if (strategies_.empty()) {
+      fprintf(stdout, "RaceContext: Strategy isn't set\n");
+      return;
+    }
+
+    size_t winner = 0;
+    const std::string result = execute(data, &winner);
+    fprintf(stdout, "RaceContext: Strategy %zu finished first:\n", winner);
+    fprintf(stdout, "%s\n", result.c_str());
+  }
+
+ private:
+  /**
+   * @brief Winner index while no strategy has succeeded
+   */
+  static constexpr size_t cNoWinner{static_cast<size_t>(-1)};
+
+  /**
+   * @brief State of one race, shared by the caller and the racing tasks
+   */
+  struct Race {
+    /**
+     * @brief Run one contestant on the input and record its outcome. A
+     * contestant still queued when the race is decided does not start.
+     */
+    void run(const Strategy &strategy, size_t index) {
+      if (stop.load(std::memory_order_relaxed)) return;
+
+      std::string output;
+      std::exception_ptr failure;
+      try {
+        output = strategy.execute_cancellable(
+            has_input ? input.c_str() : nullptr, StopToken(&stop));
+      } catch (...) {
+        failure = std::current_exception();
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      --pending;
+      if (finished) return;
+      if (!failure) {
+        result = std::move(output);
+        winner = index;
+      } else {
+        error = failure;
+        if (pending) return;
+      }
+      finished = true;
+      stop.store(true, std::memory_order_relaxed);
+      done.notify_one();
+    }
+
+    bool has_input{false};
+    std::string input;
+    std::mutex mutex;
+    std::condition_variable done;
+    std::atomic<bool> stop{false};
+    bool finished{false};
+    size_t pending{0};
+    size_t winner{cNoWinner};
+    std::string result;
+    std::exception_ptr error;
+  };
+
+  /**
+   * @brief Executor running the strategies
+   */
+  Executor &executor_;
+
+  /**
+   * @brief Racing strategies, shared with tasks still running
+   */
+  std::vector<std::shared_ptr<const Strategy>> strategies_;
+};
+
+#endif  // BEHAVIORAL_PATTERNS_STRATEGY_RACE_CONTEXT_H_
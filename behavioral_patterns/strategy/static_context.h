@@ -0,0 +1,97 @@
+#ifndef BEHAVIORAL_PATTERNS_STRATEGY_STATIC_CONTEXT_H_
+#define BEHAVIORAL_PATTERNS_STRATEGY_STATIC_CONTEXT_H_
+
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+/**
+ * @brief StaticContext is a Context whose strategy is one of a closed set of
+ * types known at compile time.
+ *
+ * The active strategy lives in place inside a std::variant, so swapping it
+ * does not allocate. Calls are dispatched with std::visit to a qualified,
+ * non-virtual execute(), which the compiler can inline. Strategies do not need
+ * to derive from Strategy, they only need a const
+ * `std::string execute(const char *)`.
+ */
+template <typename... Strategies>
+class StaticContext {
+ public:
+  /**
+   * @brief Constructor, without any strategy set
+   */
+  StaticContext() = default;
+
+  /**
+   * @brief Constructor
+   *
+   * @param type Strategy type
+   * @param args Strategy constructor arguments
+   */
+  template <typename S, typename... Args>
+  explicit StaticContext(std::in_place_type_t<S> type, Args &&...args)
+      : strategy_(type, std::forward<Args>(args)...){};
+
+  StaticContext(const StaticContext &) = delete;
+  StaticContext(StaticContext &&) = delete;
+  StaticContext operator=(const StaticContext &) = delete;
+  StaticContext operator=(StaticContext &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~StaticContext() = default;
+
+  /**
+   * @brief Strategy setter, constructs the new strategy in place.
+   *
+   * @param args Strategy constructor arguments
+   */
+  template <typename S, typename... Args>
+  void set_strategy(Args &&...args) {
+    strategy_.template emplace<S>(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Run the strategy on `data`, without any logging.
+   *
+   * @param data Data
+   * @return std::string
+   */
+  std::string execute(const char *data = nullptr) const {
+    return std::visit(
+        [data](const auto &strategy) {
+          using S = std::decay_t<decltype(strategy)>;
+          if constexpr (std::is_same<S, std::monostate>::value) {
+            return std::string();
+          } else {
+            return strategy.S::execute(data);
+          }
+        },
+        strategy_);
+  }
+
+  /**
+   * @brief The Context delegates some work to the Strategy object.
+   */
+  void do_something() const {
+    if (strategy_.index() == 0) {
+      fprintf(stdout, "StaticContext: Strategy isn't set\n");
+      return;
+    }
+
+    fprintf(stdout, "StaticContext: Execute strategy:\n");
+    fprintf(stdout, "%s\n", execute().c_str());
+  }
+
+ private:
+  /**
+   * @brief Active strategy, std::monostate when none is set
+   */
+  std::variant<std::monostate, Strategies...> strategy_;
+};
+
+#endif  // BEHAVIORAL_PATTERNS_STRATEGY_STATIC_CONTEXT_H_
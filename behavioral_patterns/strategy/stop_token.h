@@ -0,0 +1,33 @@
+#ifndef BEHAVIORAL_PATTERNS_STRATEGY_STOP_TOKEN_H_
+#define BEHAVIORAL_PATTERNS_STRATEGY_STOP_TOKEN_H_
+
+#include <atomic>
+
+/**
+ * @brief Read-only view of a cancellation flag, a minimal stand-in for C++20
+ * std::stop_token. A default constructed token is never stopped.
+ */
+class StopToken {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param flag Cancellation flag, owned by the requester
+   */
+  explicit StopToken(const std::atomic<bool> *flag = nullptr) : flag_(flag){};
+
+  /**
+   * @brief Whether cancellation has been requested
+   */
+  bool stop_requested() const {
+    return flag_ && flag_->load(std::memory_order_relaxed);
+  }
+
+ private:
+  /**
+   * @brief Cancellation flag
+   */
+  const std::atomic<bool> *flag_{nullptr};
+};
+
+#endif  // BEHAVIORAL_PATTERNS_STRATEGY_STOP_TOKEN_H_
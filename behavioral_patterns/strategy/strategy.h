@@ -0,0 +1,239 @@
+#ifndef BEHAVIORAL_PATTERNS_STRATEGY_STRATEGY_H_
+#define BEHAVIORAL_PATTERNS_STRATEGY_STRATEGY_H_
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "span.h"
+#include "stop_token.h"
+
+/**
+ * @brief Strategy
+ */
+class Strategy {
+ public:
+  /**
+   * @brief Default constructor
+   */
+  Strategy() = default;
+
+  Strategy(const Strategy &) = delete;
+  Strategy(Strategy &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~Strategy() = default;
+
+  /**
+   * @brief Execution
+   *
+   * @param data
+   * @return std::string
+   */
+  virtual std::string execute(const char *data = nullptr) const = 0;
+
+  /**
+   * @brief Cancellable execution
+   *
+   * @note The default implementation ignores the token. Long-running strategies
+   * should poll `stop.stop_requested()` and return early once it is set, their
+   * result is then discarded by the caller.
+   *
+   * @param data Data
+   * @param stop Cancellation token
+   * @return std::string
+   */
+  virtual std::string execute_cancellable(const char *data,
+                                          const StopToken &stop) const {
+    return execute(data);
+  }
+
+  /**
+   * @brief Batch execution, `out[i]` receives the result on `data[i]`.
+   *
+   * @note The default implementation calls execute() once per item. Concrete
+   * strategies can override it to process the whole batch in one call (hoisting
+   * per-call work, vectorizing, ...).
+   *
+   * @param data Inputs
+   * @param out Results, at least as many as inputs
+   */
+  virtual void execute_batch(Span<const char *const> data,
+                             Span<std::string> out) const {
+    for (size_t i = 0; i < data.size(); ++i) {
+      out[i] = execute(data[i]);
+    }
+  }
+};
+
+/**
+ * @brief Context defines the interface of interest to clients.
+ */
+class Context {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param strategy Strategy
+   */
+  explicit Context(std::unique_ptr<Strategy> &&strategy = nullptr)
+      : strategy_(std::move(strategy)){};
+
+  Context(const Context &) = delete;
+  Context(Context &&) = delete;
+  Context operator=(const Context &) = delete;
+  Context operator=(Context &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~Context() = default;
+
+  /**
+   * @brief Strategy setter to set trategy object at runtime.
+   */
+  void set_strategy(std::unique_ptr<Strategy> &&strategy) {
+    strategy_ = std::move(strategy);
+  }
+
+  /**
+   * @brief Run the strategy on `data`, without any logging.
+   *
+   * @param data Data
+   * @return std::string
+   */
+  std::string execute(const char *data = nullptr) const {
+    return strategy_ ? strategy_->execute(data) : std::string();
+  }
+
+  /**
+   * @brief Run the strategy on a batch, through a single virtual call.
+   *
+   * @param data Inputs
+   * @param out Results, at least as many as inputs
+   */
+  void execute_batch(Span<const char *const> data,
+                     Span<std::string> out) const {
+    if (strategy_) strategy_->execute_batch(data, out);
+  }
+
+  /**
+   * The Context delegates some work to the Strategy object instead of
+   * implementing +multiple versions of the algorithm on its own.
+   */
+  void do_something() const {
+    if (!strategy_) {
+      fprintf(stdout, "Context: Strategy isn't set\n");
+      return;
+    }
+
+    fprintf(stdout, "Context: Execute strategy:\n");
+    fprintf(stdout, "%s\n", strategy_->execute().c_str());
+  }
+
+ private:
+  /**
+   * @brief strategy
+   *
+   * The Context maintains a reference to one of the Strategy objects. The
+   * Context does not know the concrete class of a strategy. It should work with
+   * all strategies via the Strategy interface.
+   */
+  std::unique_ptr<Strategy> strategy_;
+};
+
+/**
+ * @brief ConcreteStrategyA inherites from Strategy
+ */
+class ConcreteStrategyA : public Strategy {
+ public:
+  ConcreteStrategyA() = delete;
+  ConcreteStrategyA(const ConcreteStrategyA &) = delete;
+  ConcreteStrategyA(ConcreteStrategyA &&) = delete;
+  ConcreteStrategyA operator=(const ConcreteStrategyA &) = delete;
+  ConcreteStrategyA operator=(ConcreteStrategyA &&) = delete;
+
+  /**
+   * @brief Constructor
+   */
+  explicit ConcreteStrategyA(size_t number) : internal_number_(number){};
+
+  /**
+   * @brief Execute
+   *
+   * @param data Data
+   * @return std::string
+   */
+  std::string execute(const char *data = nullptr) const override {
+    return "Doing something using Strategy A - Internal data \"" +
+           std::to_string(internal_number_) + "\"";
+  }
+
+  /**
+   * @brief Batch execution, the result does not depend on the input so it is
+   * formatted once for the whole batch.
+   *
+   * @param data Inputs
+   * @param out Results
+   */
+  void execute_batch(Span<const char *const> data,
+                     Span<std::string> out) const override {
+    if (data.empty()) return;
+    const std::string result = execute();
+    for (size_t i = 0; i < data.size(); ++i) {
+      out[i] = result;
+    }
+  }
+
+ private:
+  /**
+   * @brief Internal number
+   */
+  size_t internal_number_{0};
+};
+
+/**
+ * @brief ConcreteStrategyB inherites from Strategy
+ */
+class ConcreteStrategyB : public Strategy {
+ public:
+  ConcreteStrategyB() = delete;
+  ConcreteStrategyB(const ConcreteStrategyB &) = delete;
+  ConcreteStrategyB(ConcreteStrategyB &&) = delete;
+  ConcreteStrategyB operator=(const ConcreteStrategyB &) = delete;
+  ConcreteStrategyB operator=(ConcreteStrategyB &&) = delete;
+
+  /**
+   * @brief Constructor
+   *
+   * @param string String
+   */
+  explicit ConcreteStrategyB(const char *string) : internal_char_(string){};
+
+  /**
+   * @brief Destructor
+   */
+  ~ConcreteStrategyB() = default;
+
+  /**
+   * @brief Execute
+   *
+   * @param data Data
+   * @return std::string
+   */
+  std::string execute(const char *data = nullptr) const override {
+    return std::string("Doing something using Strategy B - Internal data \"") +
+           internal_char_ + "\"";
+  }
+
+ private:
+  /**
+   * @brief Internal string
+   */
+  const char *internal_char_{nullptr};
+};
+
+#endif  // BEHAVIORAL_PATTERNS_STRATEGY_STRATEGY_H_
@@ -0,0 +1,381 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "parallel_step_runner.h"
+#include "pipelined_runner.h"
+#include "static_abstract_class.h"
+#include "executor.h"
+#include "template_method.h"
+
+/**
+ * @brief Benchmark of the ways to run the template method.
+ *
+ * Every mode runs the same algorithm over the same number of documents, with
+ * synthetic step bodies of a chosen cost:
+ *  + tiny: a single addition, so that reaching the steps dominates.
+ *  + cpu: a chain of dependent multiply/xorshift rounds.
+ *  + memory: a chain of dependent loads at random places of a large buffer.
+ *
+ * Modes:
+ *  + virtual: execute_algorithm() through an AbstractClass whose concrete type
+ *    the compiler cannot see.
+ *  + crtp: StaticAbstractClass, where the steps inline.
+ *  + batch: execute_algorithm_batch() over batches of documents.
+ *  + hooks/called, hooks/skipped: a class leaving steps 5 & 6 to their empty
+ *    default, derived from AbstractClass (empty hooks called) or from
+ *    HookAwareClass (empty hooks skipped).
+ *  + pipeline: PipelinedRunner, one thread per step (document allocation
+ *    included).
+ *  + parallel-steps: ParallelStepRunner, steps 3 to 6 running concurrently.
+ *
+ * The cost is reported per step invocation (6 per document, whether or not a
+ * step is skipped) along with the document throughput, best of the
+ * repetitions.
+ *
+ * Usage: template-method-bench [--workloads=tiny,cpu,memory]
+ *                              [--documents=20000] [--repetitions=5]
+ *                              [--batch=64] [--cpu-rounds=64]
+ *                              [--memory-bytes=67108864] [--memory-loads=16]
+ *                              [--threads=N]
+ */
+
+namespace {
+
+/**
+ * @brief Sink of the steps of each thread, the main thread's is printed at the
+ * end so that no step is optimized away.
+ */
+thread_local uint64_t tSink{0};
+
+/**
+ * @brief Synthetic step bodies, by cost
+ */
+struct Tiny {
+  static void run(unsigned step) { tSink += step; }
+};
+
+struct CpuBound {
+  static size_t rounds;
+
+  static void run(unsigned step) {
+    uint64_t x = tSink + step;
+    for (size_t i = 0; i < rounds; ++i) {
+      x = x * 6364136223846793005ull + 1442695040888963407ull;
+      x ^= x >> 29;
+    }
+    tSink = x;
+  }
+};
+size_t CpuBound::rounds{64};
+
+struct MemoryBound {
+  /**
+   * @brief Single cycle through every slot, in random order
+   */
+  static std::vector<uint32_t> chain;
+  static size_t loads;
+
+  static void run(unsigned step) {
+    thread_local uint32_t cursor{0};
+    uint32_t i = cursor + step;
+    if (i >= chain.size()) i = 0;
+    for (size_t n = 0; n < loads; ++n) i = chain[i];
+    cursor = i;
+    tSink += i;
+  }
+
+  static void prepare(size_t bytes) {
+    chain.resize(std::max<size_t>(bytes / sizeof(uint32_t), 2));
+    // Sattolo's algorithm: a random permutation made of a single cycle
+    for (uint32_t i = 0; i < chain.size(); ++i) chain[i] = i;
+    std::mt19937 random(42);
+    for (size_t i = chain.size() - 1; i > 0; --i) {
+      std::uniform_int_distribution<size_t> before(0, i - 1);
+      std::swap(chain[i], chain[before(random)]);
+    }
+  }
+};
+std::vector<uint32_t> MemoryBound::chain;
+size_t MemoryBound::loads{16};
+
+/**
+ * @brief Virtual analyzer implementing every step
+ */
+template <typename Work>
+class VirtualSynthetic final
+    : public HookAwareClass<VirtualSynthetic<Work>> {
+ protected:
+  void execute_step_3(Document &document) const override { Work::run(3); }
+  void execute_step_4(Document &document) const override { Work::run(4); }
+  void execute_step_5(Document &document) const override { Work::run(5); }
+  void execute_step_6(Document &document) const override { Work::run(6); }
+};
+
+/**
+ * @brief Virtual analyzer whose steps 3 to 6 only need step 2
+ */
+template <typename Work>
+class IndependentSynthetic final
+    : public HookAwareClass<IndependentSynthetic<Work>> {
+ protected:
+  void execute_step_3(Document &document) const override { Work::run(3); }
+  void execute_step_4(Document &document) const override { Work::run(4); }
+  void execute_step_5(Document &document) const override { Work::run(5); }
+  void execute_step_6(Document &document) const override { Work::run(6); }
+
+  unsigned step_dependencies(size_t index) const override {
+    return index >= 2 ? 1u << 1 : AbstractClass::step_dependencies(index);
+  }
+};
+
+/**
+ * @brief CRTP analyzer implementing every step
+ */
+template <typename Work>
+class StaticSynthetic : public StaticAbstractClass<StaticSynthetic<Work>> {
+ protected:
+  friend class StaticAbstractClass<StaticSynthetic<Work>>;
+
+  void execute_step_3(Document &document) const { Work::run(3); }
+  void execute_step_4(Document &document) const { Work::run(4); }
+  void execute_step_5(Document &document) const { Work::run(5); }
+  void execute_step_6(Document &document) const { Work::run(6); }
+};
+
+/**
+ * @brief Analyzers leaving steps 5 & 6 to their empty default, whose empty
+ * hooks are called (plain AbstractClass) or skipped (HookAwareClass)
+ */
+template <typename Work>
+class HooksCalled : public AbstractClass {
+ protected:
+  void execute_step_3(Document &document) const override { Work::run(3); }
+  void execute_step_4(Document &document) const override { Work::run(4); }
+};
+
+template <typename Work>
+class HooksSkipped final : public HookAwareClass<HooksSkipped<Work>> {
+ protected:
+  void execute_step_3(Document &document) const override { Work::run(3); }
+  void execute_step_4(Document &document) const override { Work::run(4); }
+};
+
+/**
+ * @brief Harness settings
+ */
+struct Options {
+  std::vector<std::string> workloads{"tiny", "cpu", "memory"};
+  size_t documents{20000};
+  size_t repetitions{5};
+  size_t batch{64};
+  size_t memory_bytes{64 << 20};
+  size_t threads{std::max(std::thread::hardware_concurrency(), 1u)};
+};
+
+/**
+ * @brief One mode: runs the algorithm over every document once.
+ */
+struct Mode {
+  std::string name;
+  std::function<void(std::vector<Document> &)> run;
+};
+
+/**
+ * @brief Hide the concrete type of `analyzer`, as client code working on
+ * AbstractClass would.
+ */
+const AbstractClass *opaque(const AbstractClass &analyzer) {
+  const AbstractClass *volatile hidden = &analyzer;
+  return hidden;
+}
+
+/**
+ * @brief Modes timed on workload `Work`
+ */
+template <typename Work>
+std::vector<Mode> make_modes(const Options &options,
+                             std::shared_ptr<Executor> pool) {
+  std::vector<Mode> modes;
+
+  auto virtual_analyzer = std::make_shared<VirtualSynthetic<Work>>();
+  modes.push_back({"virtual", [virtual_analyzer](std::vector<Document> &in) {
+                     const AbstractClass *analyzer = opaque(*virtual_analyzer);
+                     for (Document &document : in) {
+                       analyzer->execute_algorithm(document);
+                     }
+                   }});
+
+  auto static_analyzer = std::make_shared<StaticSynthetic<Work>>();
+  modes.push_back({"crtp", [static_analyzer](std::vector<Document> &in) {
+                     for (Document &document : in) {
+                       static_analyzer->execute_algorithm(document);
+                     }
+                   }});
+
+  const size_t batch = options.batch;
+  modes.push_back({"batch",
+                   [virtual_analyzer, batch](std::vector<Document> &in) {
+                     const AbstractClass *analyzer = opaque(*virtual_analyzer);
+                     for (size_t i = 0; i < in.size(); i += batch) {
+                       const size_t n = std::min(batch, in.size() - i);
+                       analyzer->execute_algorithm_batch({&in[i], n});
+                     }
+                   }});
+
+  auto hooks_called = std::make_shared<HooksCalled<Work>>();
+  modes.push_back({"hooks/called", [hooks_called](std::vector<Document> &in) {
+                     const AbstractClass *analyzer = opaque(*hooks_called);
+                     for (Document &document : in) {
+                       analyzer->execute_algorithm(document);
+                     }
+                   }});
+
+  auto hooks_skipped = std::make_shared<HooksSkipped<Work>>();
+  modes.push_back({"hooks/skipped", [hooks_skipped](std::vector<Document> &in) {
+                     const AbstractClass *analyzer = opaque(*hooks_skipped);
+                     for (Document &document : in) {
+                       analyzer->execute_algorithm(document);
+                     }
+                   }});
+
+  modes.push_back({"pipeline", [virtual_analyzer](std::vector<Document> &in) {
+                     PipelinedRunner runner(*virtual_analyzer);
+                     size_t next = 0;
+                     runner.run(
+                         [&]() -> std::unique_ptr<Document> {
+                           if (next == in.size()) return nullptr;
+                           return std::make_unique<Document>(in[next++]);
+                         },
+                         [](std::unique_ptr<Document>) {});
+                   }});
+
+  auto independent = std::make_shared<IndependentSynthetic<Work>>();
+  modes.push_back({"parallel-steps",
+                   [independent, pool](std::vector<Document> &in) {
+                     ParallelStepRunner runner(*independent, *pool);
+                     for (Document &document : in) runner.run(document);
+                   }});
+
+  return modes;
+}
+
+/**
+ * @brief Time every mode on workload `Work` and print one CSV line per mode
+ */
+template <typename Work>
+void measure(const char *workload, const Options &options,
+             std::shared_ptr<Executor> pool) {
+  std::vector<Document> documents(options.documents,
+                                  Document{"bench", nullptr});
+  for (const Mode &mode : make_modes<Work>(options, pool)) {
+    mode.run(documents);  // Warm up
+
+    double best = 0.0;
+    for (size_t r = 0; r < options.repetitions; ++r) {
+      const auto start = std::chrono::steady_clock::now();
+      mode.run(documents);
+      const std::chrono::duration<double, std::nano> elapsed =
+          std::chrono::steady_clock::now() - start;
+      if (r == 0 || elapsed.count() < best) best = elapsed.count();
+    }
+
+    const double ns_per_step =
+        best / (documents.size() * AbstractClass::cStepCount);
+    const double documents_per_s = best > 0.0 ? documents.size() * 1e9 / best
+                                              : 0.0;
+    fprintf(stdout, "%s,%s,%zu,%.3f,%.0f\n", workload, mode.name.c_str(),
+            documents.size(), ns_per_step, documents_per_s);
+  }
+}
+
+/**
+ * @brief Parse a comma-separated list of workloads
+ */
+std::vector<std::string> parse_workloads(const char *list) {
+  std::vector<std::string> workloads;
+  for (const char *p = list; *p;) {
+    const char *end = strchr(p, ',');
+    if (!end) end = p + strlen(p);
+    const std::string workload(p, end);
+    if (workload != "tiny" && workload != "cpu" && workload != "memory") {
+      return {};
+    }
+    workloads.push_back(workload);
+    p = *end == ',' ? end + 1 : end;
+  }
+  return workloads;
+}
+
+/**
+ * @brief Parse the command line, returns false on invalid arguments
+ */
+bool parse(int argc, char **argv, Options *options) {
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    const char *value = strchr(arg, '=');
+    if (!value) return false;
+    const std::string key(arg, value++);
+    if (key == "--workloads") {
+      options->workloads = parse_workloads(value);
+      if (options->workloads.empty()) return false;
+    } else if (key == "--documents") {
+      options->documents = strtoull(value, nullptr, 10);
+    } else if (key == "--repetitions") {
+      options->repetitions = strtoull(value, nullptr, 10);
+    } else if (key == "--batch") {
+      options->batch = strtoull(value, nullptr, 10);
+    } else if (key == "--cpu-rounds") {
+      CpuBound::rounds = strtoull(value, nullptr, 10);
+    } else if (key == "--memory-bytes") {
+      options->memory_bytes = strtoull(value, nullptr, 10);
+    } else if (key == "--memory-loads") {
+      MemoryBound::loads = strtoull(value, nullptr, 10);
+    } else if (key == "--threads") {
+      options->threads = strtoull(value, nullptr, 10);
+    } else {
+      return false;
+    }
+  }
+  return options->documents && options->repetitions && options->batch &&
+         options->threads;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parse(argc, argv, &options)) {
+    fprintf(stderr,
+            "Usage: %s [--workloads=tiny,cpu,memory] [--documents=20000] "
+            "[--repetitions=5] [--batch=64] [--cpu-rounds=64] "
+            "[--memory-bytes=67108864] [--memory-loads=16] [--threads=N]\n",
+            argv[0]);
+    return 1;
+  }
+
+  auto pool = std::make_shared<Executor>(options.threads);
+  fprintf(stdout, "workload,mode,documents,ns_per_step,documents_per_s\n");
+  for (const std::string &workload : options.workloads) {
+    if (workload == "tiny") {
+      measure<Tiny>("tiny", options, pool);
+    } else if (workload == "cpu") {
+      measure<CpuBound>("cpu", options, pool);
+    } else {
+      MemoryBound::prepare(options.memory_bytes);
+      measure<MemoryBound>("memory", options, pool);
+    }
+  }
+
+  fprintf(stderr, "(sink %llu)\n", static_cast<unsigned long long>(tSink));
+  return 0;
+}
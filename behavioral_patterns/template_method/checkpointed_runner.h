@@ -0,0 +1,148 @@
+#ifndef BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_CHECKPOINTED_RUNNER_H_
+#define BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_CHECKPOINTED_RUNNER_H_
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <utility>
+
+#include "template_method.h"
+
+/**
+ * @brief CheckpointedRunner runs the algorithm with a checkpoint after every
+ * step, so that a rerun after a failure resumes from the last completed step
+ * instead of step 1.
+ *
+ * A checkpoint is a local file holding the concrete class, the document name,
+ * the number of completed steps and the state written by
+ * AbstractClass::save_state(). It is written to a temporary file then renamed
+ * over the previous one, so a crash while checkpointing leaves the previous
+ * checkpoint intact. The checkpoint is removed once every step is done.
+ *
+ * A checkpoint of another class or document, or one that cannot be read back,
+ * is ignored and the algorithm starts over, so load_state() should only update
+ * the document once it has read the whole state.
+ */
+class CheckpointedRunner {
+ public:
+  CheckpointedRunner() = delete;
+
+  /**
+   * @brief Constructor
+   *
+   * @param analyzer Analyzer running the steps
+   * @param path Checkpoint file
+   */
+  CheckpointedRunner(const AbstractClass &analyzer, std::string path)
+      : analyzer_(analyzer), path_(std::move(path)){};
+
+  CheckpointedRunner(const CheckpointedRunner &) = delete;
+  CheckpointedRunner(CheckpointedRunner &&) = delete;
+  CheckpointedRunner operator=(const CheckpointedRunner &) = delete;
+  CheckpointedRunner operator=(CheckpointedRunner &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~CheckpointedRunner() = default;
+
+  /**
+   * @brief Run the algorithm on `document`, resuming from the checkpoint if
+   * there is one.
+   *
+   * @note If a step throws, the checkpoint of the steps before it is kept and
+   * the exception propagates. Throws std::runtime_error if a checkpoint
+   * cannot be written.
+   *
+   * @param document Document
+   * @return Number of steps skipped thanks to the checkpoint
+   */
+  size_t run(Document &document) const {
+    const size_t resumed = resume(document);
+    for (size_t step = resumed; step < AbstractClass::cStepCount; ++step) {
+      analyzer_.execute_step(step, document);
+      if (step + 1 < AbstractClass::cStepCount) save(document, step + 1);
+    }
+    std::remove(path_.c_str());
+    return resumed;
+  }
+
+ private:
+  /**
+   * @brief Restore `document` from the checkpoint, returns the number of
+   * completed steps (0 without a usable checkpoint).
+   */
+  size_t resume(Document &document) const {
+    FILE *in = fopen(path_.c_str(), "rb");
+    if (!in) return 0;
+
+    size_t completed = 0;
+    const bool valid =
+        read_line(in) == typeid(analyzer_).name() &&
+        read_line(in) == document.name &&
+        parse_count(read_line(in), &completed) &&
+        completed < AbstractClass::cStepCount &&
+        analyzer_.load_state(document, in);
+    fclose(in);
+    return valid ? completed : 0;
+  }
+
+  /**
+   * @brief Checkpoint `document` after `completed` steps
+   */
+  void save(const Document &document, size_t completed) const {
+    const std::string temporary = path_ + ".tmp";
+    FILE *out = fopen(temporary.c_str(), "wb");
+    if (!out) throw std::runtime_error("Cannot write checkpoint " + temporary);
+
+    bool written = fprintf(out, "%s\n%s\n%zu\n", typeid(analyzer_).name(),
+                           document.name.c_str(), completed) > 0 &&
+                   analyzer_.save_state(document, out);
+    written = fclose(out) == 0 && written;
+    if (!written || std::rename(temporary.c_str(), path_.c_str()) != 0) {
+      std::remove(temporary.c_str());
+      throw std::runtime_error("Cannot write checkpoint " + path_);
+    }
+  }
+
+  /**
+   * @brief Read one line of `in`, without the newline
+   */
+  static std::string read_line(FILE *in) {
+    std::string line;
+    for (int c = fgetc(in); c != EOF && c != '\n'; c = fgetc(in)) {
+      line.push_back(static_cast<char>(c));
+    }
+    return line;
+  }
+
+  /**
+   * @brief Parse a line holding only a decimal count. The line is read on its
+   * own so that the state after it starts exactly where save_state() began.
+   */
+  static bool parse_count(const std::string &line, size_t *count) {
+    if (line.empty() || line[0] < '0' || line[0] > '9') return false;
+    char *end = nullptr;
+    errno = 0;
+    const unsigned long long value = std::strtoull(line.c_str(), &end, 10);
+    if (errno || *end != '\0') return false;
+    *count = static_cast<size_t>(value);
+    return true;
+  }
+
+  /**
+   * @brief Analyzer running the steps
+   */
+  const AbstractClass &analyzer_;
+
+  /**
+   * @brief Checkpoint file
+   */
+  const std::string path_;
+};
+
+#endif  // BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_CHECKPOINTED_RUNNER_H_
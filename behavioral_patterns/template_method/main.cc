@@ -1,4 +1,17 @@
 #include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+
+#include "checkpointed_runner.h"
+#include "mapped_file.h"
+#include "parallel_driver.h"
+#include "parallel_step_runner.h"
+#include "pipelined_runner.h"
+#include "static_abstract_class.h"
+#include "step_profiler.h"
+#include "template_method.h"
 
 /**
  * @brief Template Method is a behavioral design pattern that defines the
@@ -40,173 +53,190 @@
 ////////////////////////////////////////////////////////////
 
 /**
- * @brief AbstractClass name
+ * The client code calls the template method to execute the algorithm. Client
+ * code does not have to know the concrete class of an object it works with, as
+ * long as it works with objects through the interface of their base class.
  */
-static const char *cAbstractClassName{"AbstractClass"};
+void run_client(AbstractClass *obj, Document &document) {
+  obj->execute_algorithm(document);
+}
 
 /**
- * @brief ConcreteClass1 name
+ * Concrete class whose step 5 fails on its first run, as on a truncated input.
+ * Its checkpointed state starts with whitespace, which must come back as is.
  */
-static const char *cConcreteClass1Name{"ConcreteClass1"};
+class FlakyClass final : public HookAwareClass<FlakyClass> {
+ protected:
+  void execute_step_3(Document &document) const override {
+    report_step(document, "FlakyClass", 3);
+  }
 
-/**
- * @brief ConcreteClass2 name
- */
-static const char *cConcreteClass2Name{"ConcreteClass2"};
+  void execute_step_4(Document &document) const override {
+    report_step(document, "FlakyClass", 4);
+  }
 
-/**
- * @brief The Abstract Class defines a template method that contains a skeleton
- * of some algorithm, composed of calls to (usually) abstract primitive
- * operations.
- *
- * Concrete subclasses should implement these operations, but leave the template
- * method itself intact.
- */
-class AbstractClass {
- public:
-  /**
-   * @brief Constructor
-   */
-  AbstractClass() = default;
-
-  AbstractClass(const AbstractClass &) = delete;
-  AbstractClass(AbstractClass &&) = delete;
-
-  /**
-   * @brief Destructor
-   */
-  virtual ~AbstractClass() = default;
-
-  /**
-   * @brief The template method defines the skeleton of an algorithm.
-   */
-  void execute_algorithm() const {
-    this->execute_step_1();
-    this->execute_step_2();
-    this->execute_step_3();
-    this->execute_step_4();
-    this->execute_step_5();
-    this->execute_step_6();
+  void execute_step_5(Document &document) const override {
+    if (!failed_) {
+      failed_ = true;
+      throw std::runtime_error("input truncated");
+    }
+    report_step(document, "FlakyClass", 5);
   }
 
- protected:
-  /**
-   * Step 1 & 2 (Base operations)
-   */
-  void execute_step_1() const {
-    fprintf(stdout, "%s: Implements step 1\n", cAbstractClassName);
+  bool save_state(const Document &document, FILE *out) const override {
+    return fputs(cState, out) >= 0;
   }
-  void execute_step_2() const {
-    fprintf(stdout, "%s: Implements step 2\n", cAbstractClassName);
+
+  bool load_state(Document &document, FILE *in) const override {
+    char state[16] = {};
+    if (!fgets(state, sizeof(state), in) || strcmp(state, cState) != 0) {
+      return false;
+    }
+    fprintf(stdout, "Restored state \"%.*s\"\n",
+            static_cast<int>(strlen(state) - 1), state);
+    return true;
   }
 
-  /**
-   * Step 3 & 4 (overriding required).
-   */
-  virtual void execute_step_3() const = 0;
-  virtual void execute_step_4() const = 0;
-
-  /**
-   * Step 3 & 4 (overriding optional).
-   */
-  virtual void execute_step_5() const {}
-  virtual void execute_step_6() const {}
+ private:
+  static constexpr const char *cState{"\t  state\n"};
+
+  mutable bool failed_{false};
 };
 
 /**
- * @brief Concrete class 2
- *
- * This class overrides required steps (3 & 4), and uses default implementation
- * of step 5 & 6
+ * Concrete class overriding both optional steps, which only need step 4
  */
-class ConcreteClass1 : public AbstractClass {
- public:
-  /**
-   * @brief Constructor
-   */
-  ConcreteClass1() = default;
-
-  ConcreteClass1(const ConcreteClass1 &) = delete;
-  ConcreteClass1(ConcreteClass1 &&) = delete;
-  ConcreteClass1 operator=(const ConcreteClass1 &) = delete;
-  ConcreteClass1 operator=(ConcreteClass1 &&) = delete;
-
-  /**
-   * @brief Destructor
-   */
-  ~ConcreteClass1() = default;
-
+class ParallelClass final : public HookAwareClass<ParallelClass> {
  protected:
-  /**
-   * Override step 3 4 (required)
-   */
-  void execute_step_3() const override {
-    fprintf(stdout, "%s: Implements step 3\n", cConcreteClass1Name);
+  void execute_step_3(Document &document) const override {
+    report_step(document, "ParallelClass", 3);
   }
 
-  void execute_step_4() const override {
-    fprintf(stdout, "%s: Implements step 4\n", cConcreteClass1Name);
+  void execute_step_4(Document &document) const override {
+    report_step(document, "ParallelClass", 4);
   }
-};
 
-/**
- * @brief Concrete class 2
- *
- * This class overrides required steps (3 & 4), and some optional steps (5)
- */
-class ConcreteClass2 : public AbstractClass {
- public:
-  /**
-   * @brief Constructor
-   */
-  ConcreteClass2() = default;
-
-  ConcreteClass2(const ConcreteClass2 &) = delete;
-  ConcreteClass2(ConcreteClass2 &&) = delete;
-  ConcreteClass2 operator=(const ConcreteClass2 &) = delete;
-  ConcreteClass2 operator=(ConcreteClass2 &&) = delete;
-
-  /**
-   * @brief Destructor
-   */
-  ~ConcreteClass2() = default;
-
- protected:
-  /**
-   * Override step 3 4 (required)
-   */
-  void execute_step_3() const override {
-    fprintf(stdout, "%s: Implements step 3\n", cConcreteClass2Name);
+  void execute_step_5(Document &document) const override {
+    report_step(document, "ParallelClass", 5);
   }
 
-  void execute_step_4() const override {
-    fprintf(stdout, "%s: Implements step 4\n", cConcreteClass2Name);
+  void execute_step_6(Document &document) const override {
+    report_step(document, "ParallelClass", 6);
   }
 
-  /**
-   * Override step 5
-   */
-  void execute_step_5() const override {
-    fprintf(stdout, "%s: Implements step 5\n", cConcreteClass2Name);
+  unsigned step_dependencies(size_t index) const override {
+    return index == 5 ? 1u << 3 : AbstractClass::step_dependencies(index);
   }
 };
 
-/**
- * The client code calls the template method to execute the algorithm. Client
- * code does not have to know the concrete class of an object it works with, as
- * long as it works with objects through the interface of their base class.
- */
-void run_client(AbstractClass *obj) { obj->execute_algorithm(); }
-
 int main() {
+  Document document{"report.pdf"};
+
   fprintf(stdout, "Same client code can work with different subclasses:\n");
   ConcreteClass1 concrete_class_1;
-  run_client(&concrete_class_1);
+  run_client(&concrete_class_1, document);
   fprintf(stdout, "\n");
 
   fprintf(stdout, "Same client code can work with different subclasses:\n");
   ConcreteClass2 concrete_class_2;
-  run_client(&concrete_class_2);
+  run_client(&concrete_class_2, document);
+  fprintf(stdout, "\n");
+
+  fprintf(stdout, "A batch of documents can go through each step at once:\n");
+  Document batch[] = {{"a.doc"}, {"b.doc"}};
+  concrete_class_1.execute_algorithm_batch(batch);
+  fprintf(stdout, "\n");
+
+  fprintf(stdout, "A stream of documents can go through a pipeline:\n");
+  const char *names[] = {"a.csv", "b.csv", "c.csv"};
+  size_t next = 0;
+  PipelinedRunner runner(concrete_class_2);
+  runner.run(
+      [&names, &next]() -> std::unique_ptr<Document> {
+        if (next == 3) return nullptr;
+        return std::make_unique<Document>(Document{names[next++]});
+      },
+      [](std::unique_ptr<Document> document) {
+        fprintf(stdout, "Done with %s\n", document->name.c_str());
+      });
+  fprintf(stdout, "\n");
+
+  fprintf(stdout, "The same algorithm, resolved at compile time:\n");
+  StaticConcreteClass2 static_concrete_class_2;
+  static_concrete_class_2.execute_algorithm(document);
+  fprintf(stdout, "\n");
+
+  fprintf(stdout,
+          "Independent steps can run in parallel (5 & 6 after 4):\n");
+  {
+    Executor executor(2);
+    Document parallel{"parallel.doc"};
+    ParallelClass parallel_class;
+    ParallelStepRunner(parallel_class, executor).run(parallel);
+  }
+  fprintf(stdout, "\n");
+
+  fprintf(stdout, "A rerun resumes from the last completed step:\n");
+  {
+    FlakyClass flaky;
+    CheckpointedRunner runner(flaky, "report.pdf.checkpoint");
+    try {
+      runner.run(document);
+    } catch (const std::exception &e) {
+      fprintf(stdout, "Failed: %s\n", e.what());
+    }
+    const size_t resumed = runner.run(document);
+    fprintf(stdout, "Resumed after step %zu\n", resumed);
+  }
+  fprintf(stdout, "\n");
+
+  fprintf(stdout, "Steps can read a mapped file without copying it:\n");
+  if (FILE *csv = fopen("mapped.csv", "w")) {
+    fprintf(csv, "id,value\n1,42\n2,7\n");
+    fclose(csv);
+    {
+      MappedFile file("mapped.csv");
+      Document mapped = file.document();
+      run_client(&concrete_class_1, mapped);
+    }
+    std::remove("mapped.csv");
+  }
+  fprintf(stdout, "\n");
+
+  fprintf(stdout, "Whole directories can be analysed in parallel:\n");
+  {
+    const auto directory =
+        std::filesystem::temp_directory_path() / "template-method-documents";
+    std::filesystem::create_directories(directory);
+    for (const char *name : {"a.csv", "b.csv", "c.pdf", "d.txt"}) {
+      if (FILE *file = fopen((directory / name).string().c_str(), "w")) {
+        fprintf(file, "%s\n", name);
+        fclose(file);
+      }
+    }
+
+    ParallelDriver driver(2);
+    driver.register_format(
+        ".csv", [] { return std::make_unique<ConcreteClass1>(); });
+    driver.register_format(
+        ".pdf", [] { return std::make_unique<ConcreteClass2>(); });
+    const auto summary = driver.run_directory(directory.string());
+    fprintf(stdout, "Analysed %zu, unsupported %zu, failed %zu\n",
+            summary.analyzed, summary.unsupported, summary.failed);
+    std::filesystem::remove_all(directory);
+  }
+  fprintf(stdout, "\n");
+
+  fprintf(stdout, "Steps can be timed per concrete class:\n");
+  StepProfiler profiler;
+  concrete_class_1.enable_profiling(profiler);
+  concrete_class_2.enable_profiling(profiler);
+  Document quiet{"quiet.csv", nullptr};
+  for (int i = 0; i < 100; ++i) {
+    run_client(&concrete_class_1, quiet);
+    run_client(&concrete_class_2, quiet);
+  }
+  profiler.print(stdout);
 
   return 0;
 }
@@ -0,0 +1,119 @@
+#ifndef BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_MAPPED_FILE_H_
+#define BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "span.h"
+#include "template_method.h"
+
+/**
+ * @brief Read-only view of a whole file, mapped into memory with mmap() so that
+ * steps read straight from the page cache instead of copies of the file.
+ *
+ * The views handed out stay valid as long as the MappedFile lives. Where mmap()
+ * is unavailable, the file is read into memory once instead.
+ */
+class MappedFile {
+ public:
+  MappedFile() = delete;
+
+  /**
+   * @brief Constructor, throws std::runtime_error if the file cannot be mapped
+   *
+   * @param path File path
+   */
+  explicit MappedFile(const std::string &path) : path_(path) {
+#if defined(__unix__) || defined(__APPLE__)
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Cannot open " + path);
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+      close(fd);
+      throw std::runtime_error("Cannot stat " + path);
+    }
+    size_ = static_cast<size_t>(status.st_size);
+    if (size_) {
+      void *mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("Cannot map " + path);
+      }
+      // Steps scan documents front to back: ask for aggressive read-ahead
+      madvise(mapping, size_, MADV_SEQUENTIAL);
+      data_ = static_cast<const char *>(mapping);
+    }
+    close(fd);
+#else
+    FILE *in = fopen(path.c_str(), "rb");
+    if (!in) throw std::runtime_error("Cannot open " + path);
+    char buffer[1 << 16];
+    for (size_t n; (n = fread(buffer, 1, sizeof(buffer), in)) > 0;) {
+      copy_.append(buffer, n);
+    }
+    fclose(in);
+    data_ = copy_.data();
+    size_ = copy_.size();
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile(MappedFile &&) = delete;
+  MappedFile operator=(const MappedFile &) = delete;
+  MappedFile operator=(MappedFile &&) = delete;
+
+  /**
+   * @brief Destructor, unmaps the file
+   */
+  ~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (size_) munmap(const_cast<char *>(data_), size_);
+#endif
+  }
+
+  /**
+   * @brief Contents of the file
+   */
+  std::string_view view() const { return std::string_view(data_, size_); }
+  Span<const char> span() const { return Span<const char>(data_, size_); }
+
+  /**
+   * @brief Document viewing the file, named after its path
+   *
+   * @param log Where steps report their progress
+   */
+  Document document(FILE *log = stdout) const {
+    return Document{path_, log, view()};
+  }
+
+ private:
+  /**
+   * @brief File path
+   */
+  const std::string path_;
+
+  /**
+   * @brief Contents of the file
+   */
+  const char *data_{nullptr};
+  size_t size_{0};
+
+#if !(defined(__unix__) || defined(__APPLE__))
+  /**
+   * @brief Copy of the file where it cannot be mapped
+   */
+  std::string copy_;
+#endif
+};
+
+#endif  // BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_MAPPED_FILE_H_
@@ -0,0 +1,197 @@
+#ifndef BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_PARALLEL_DRIVER_H_
+#define BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_PARALLEL_DRIVER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "mapped_file.h"
+#include "template_method.h"
+
+/**
+ * @brief ParallelDriver analyses many documents at once, picking the concrete
+ * class of each document from its format (file extension).
+ *
+ * Inputs are split evenly between worker threads. A worker that runs out of
+ * inputs steals half of the inputs left to another worker, so one slow
+ * document does not hold back a whole share. Each worker builds at most one
+ * analyzer per format, on first use, and reuses it for every later document of
+ * that format. Documents are read through MappedFile.
+ */
+class ParallelDriver {
+ public:
+  /**
+   * @brief Builds the analyzer of a format
+   */
+  using Factory = std::function<std::unique_ptr<AbstractClass>()>;
+
+  /**
+   * @brief Outcome of a run
+   */
+  struct Summary {
+    size_t analyzed{0};
+    size_t unsupported{0};
+    size_t failed{0};
+  };
+
+  /**
+   * @brief Constructor
+   *
+   * @param threads Number of worker threads
+   */
+  explicit ParallelDriver(
+      size_t threads = std::thread::hardware_concurrency())
+      : threads_(threads ? threads : 1){};
+
+  ParallelDriver(const ParallelDriver &) = delete;
+  ParallelDriver(ParallelDriver &&) = delete;
+  ParallelDriver operator=(const ParallelDriver &) = delete;
+  ParallelDriver operator=(ParallelDriver &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~ParallelDriver() = default;
+
+  /**
+   * @brief Analyse documents with `extension` (e.g. ".csv") with analyzers
+   * built by `factory`
+   */
+  void register_format(std::string extension, Factory factory) {
+    factories_[std::move(extension)] = std::move(factory);
+  }
+
+  /**
+   * @brief Analyse every regular file under `directory`, recursively
+   *
+   * @param directory Directory
+   * @param log Where steps report their progress, nullptr to keep them quiet
+   */
+  Summary run_directory(const std::string &directory,
+                        FILE *log = nullptr) const {
+    std::vector<std::string> paths;
+    for (const auto &entry :
+         std::filesystem::recursive_directory_iterator(directory)) {
+      if (entry.is_regular_file()) paths.push_back(entry.path().string());
+    }
+    return run(paths, log);
+  }
+
+  /**
+   * @brief Analyse every document of `paths`
+   *
+   * @note Documents of an unregistered format are counted as unsupported.
+   * Documents that cannot be read, or whose analysis throws, are counted as
+   * failed; the other documents are still analysed.
+   *
+   * @param paths Document paths
+   * @param log Where steps report their progress, nullptr to keep them quiet
+   */
+  Summary run(const std::vector<std::string> &paths,
+              FILE *log = nullptr) const {
+    const size_t workers =
+        std::min(threads_, std::max<size_t>(paths.size(), 1));
+    std::vector<Share> shares(workers);
+    for (size_t w = 0; w < workers; ++w) {
+      shares[w].begin = paths.size() * w / workers;
+      shares[w].end = paths.size() * (w + 1) / workers;
+    }
+
+    std::atomic<size_t> analyzed{0}, unsupported{0}, failed{0};
+    auto work = [&](size_t self) {
+      std::unordered_map<std::string, std::unique_ptr<AbstractClass>> analyzers;
+      for (size_t i = 0; take(shares, self, &i);) {
+        const std::string extension =
+            std::filesystem::path(paths[i]).extension().string();
+        const auto factory = factories_.find(extension);
+        if (factory == factories_.end()) {
+          unsupported.fetch_add(1, std::memory_order_relaxed);
+          continue;
+        }
+        auto &analyzer = analyzers[extension];
+        try {
+          if (!analyzer) analyzer = factory->second();
+          MappedFile file(paths[i]);
+          Document document = file.document(log);
+          analyzer->execute_algorithm(document);
+          analyzed.fetch_add(1, std::memory_order_relaxed);
+        } catch (...) {
+          failed.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers; ++w) threads.emplace_back(work, w);
+    work(0);
+    for (auto &thread : threads) thread.join();
+    return Summary{analyzed, unsupported, failed};
+  }
+
+ private:
+  /**
+   * @brief Inputs [begin, end) left to one worker
+   */
+  struct alignas(64) Share {
+    std::mutex mutex;
+    size_t begin{0};
+    size_t end{0};
+  };
+
+  /**
+   * @brief Take the next input of worker `self` into `index`, stealing from
+   * the other workers once its own share is done. Returns false when no input
+   * is left anywhere.
+   */
+  static bool take(std::vector<Share> &shares, size_t self, size_t *index) {
+    Share &own = shares[self];
+    {
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (own.begin < own.end) {
+        *index = own.begin++;
+        return true;
+      }
+    }
+
+    for (size_t k = 1; k < shares.size(); ++k) {
+      Share &victim = shares[(self + k) % shares.size()];
+      size_t begin, end;
+      {
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.begin == victim.end) continue;
+        // Steal the back half, the victim keeps the inputs it is closest to
+        begin = victim.begin + (victim.end - victim.begin) / 2;
+        end = victim.end;
+        victim.end = begin;
+      }
+      std::lock_guard<std::mutex> lock(own.mutex);
+      own.begin = begin + 1;
+      own.end = end;
+      *index = begin;
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Number of worker threads
+   */
+  const size_t threads_;
+
+  /**
+   * @brief Analyzer factory of each format, by extension
+   */
+  std::unordered_map<std::string, Factory> factories_;
+};
+
+#endif  // BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_PARALLEL_DRIVER_H_
@@ -0,0 +1,171 @@
+#ifndef BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_PARALLEL_STEP_RUNNER_H_
+#define BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_PARALLEL_STEP_RUNNER_H_
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "executor.h"
+#include "template_method.h"
+
+/**
+ * @brief ParallelStepRunner runs the steps of one document as a dependency
+ * graph on an Executor.
+ *
+ * The graph comes from AbstractClass::step_dependencies(). Every step whose
+ * dependencies have completed is submitted to the executor, so independent
+ * steps (e.g. optional steps 5 & 6 both needing only step 4) run concurrently,
+ * and a step never starts before the steps it depends on have finished.
+ *
+ * @note Steps running concurrently share the document: they must not touch
+ * the same data. run() blocks the calling thread, which must not be a worker
+ * of the same executor.
+ */
+class ParallelStepRunner {
+ public:
+  ParallelStepRunner() = delete;
+
+  /**
+   * @brief Constructor
+   *
+   * @param analyzer Analyzer running the steps
+   * @param executor Executor running the steps
+   */
+  ParallelStepRunner(const AbstractClass &analyzer, Executor &executor)
+      : analyzer_(analyzer), executor_(executor) {
+    for (size_t step = 0; step < cSteps; ++step) {
+      const unsigned dependencies = analyzer_.step_dependencies(step);
+      if (dependencies & ~((1u << step) - 1)) {
+        throw std::logic_error("Steps may only depend on earlier steps");
+      }
+      dependencies_[step] = 0;
+      for (size_t before = 0; before < step; ++before) {
+        if (dependencies & (1u << before)) {
+          ++dependencies_[step];
+          dependents_[before].push_back(step);
+        }
+      }
+    }
+  }
+
+  ParallelStepRunner(const ParallelStepRunner &) = delete;
+  ParallelStepRunner(ParallelStepRunner &&) = delete;
+  ParallelStepRunner operator=(const ParallelStepRunner &) = delete;
+  ParallelStepRunner operator=(ParallelStepRunner &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~ParallelStepRunner() = default;
+
+  /**
+   * @brief Run the algorithm on `document`, returns once every step is done.
+   *
+   * @note If a step throws, the steps depending on it are not run and the
+   * first exception is rethrown.
+   *
+   * @param document Document
+   */
+  void run(Document &document) const {
+    Run state(document, dependencies_);
+    for (size_t step = 0; step < cSteps; ++step) {
+      if (!dependencies_[step]) submit(state, step);
+    }
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.done.wait(lock, [&state] { return state.finished == cSteps; });
+    if (state.error) std::rethrow_exception(state.error);
+  }
+
+ private:
+  /**
+   * @brief Number of steps
+   */
+  static constexpr size_t cSteps{AbstractClass::cStepCount};
+
+  /**
+   * @brief State of one run
+   */
+  struct Run {
+    Run(Document &document, const std::array<size_t, cSteps> &pending)
+        : document(document), pending(pending) {}
+
+    Document &document;
+    std::array<size_t, cSteps> pending;
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t finished{0};
+    unsigned skipped{0};
+    std::exception_ptr error;
+  };
+
+  /**
+   * @brief Run `step` on the executor, then release the steps depending on it.
+   * A failed step releases nothing: its dependents count as finished without
+   * running.
+   */
+  void submit(Run &state, size_t step) const {
+    executor_.submit([this, &state, step] {
+      std::exception_ptr failure;
+      try {
+        analyzer_.execute_step(step, state.document);
+      } catch (...) {
+        failure = std::current_exception();
+      }
+
+      std::vector<size_t> ready;
+      std::lock_guard<std::mutex> lock(state.mutex);
+      if (failure) {
+        if (!state.error) state.error = failure;
+        state.finished += 1 + skip_dependents(state, step);
+      } else {
+        ++state.finished;
+        for (const size_t next : dependents_[step]) {
+          if (--state.pending[next] == 0) ready.push_back(next);
+        }
+      }
+      for (const size_t next : ready) submit(state, next);
+      if (state.finished == cSteps) state.done.notify_one();
+    });
+  }
+
+  /**
+   * @brief Mark the steps depending, directly or not, on `step` as skipped,
+   * returns how many were not skipped already
+   */
+  size_t skip_dependents(Run &state, size_t step) const {
+    unsigned reached = 1u << step;
+    size_t count = 0;
+    for (size_t next = step + 1; next < cSteps; ++next) {
+      if (!(analyzer_.step_dependencies(next) & reached)) continue;
+      reached |= 1u << next;
+      if (!(state.skipped & (1u << next))) {
+        state.skipped |= 1u << next;
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  /**
+   * @brief Analyzer running the steps
+   */
+  const AbstractClass &analyzer_;
+
+  /**
+   * @brief Executor running the steps
+   */
+  Executor &executor_;
+
+  /**
+   * @brief Number of dependencies of each step, and steps depending on it
+   */
+  std::array<size_t, cSteps> dependencies_{};
+  std::array<std::vector<size_t>, cSteps> dependents_;
+};
+
+#endif  // BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_PARALLEL_STEP_RUNNER_H_
@@ -0,0 +1,208 @@
+#ifndef BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_PIPELINED_RUNNER_H_
+#define BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_PIPELINED_RUNNER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "template_method.h"
+
+/**
+ * @brief Bounded blocking FIFO queue between two pipeline stages
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param capacity Maximum number of queued items
+   */
+  explicit BoundedQueue(size_t capacity) : capacity_(capacity ? capacity : 1){};
+
+  BoundedQueue(const BoundedQueue &) = delete;
+  BoundedQueue(BoundedQueue &&) = delete;
+  BoundedQueue operator=(const BoundedQueue &) = delete;
+  BoundedQueue operator=(BoundedQueue &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~BoundedQueue() = default;
+
+  /**
+   * @brief Push an item, waits while the queue is full
+   */
+  void push(T item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return items_.size() < capacity_; });
+    items_.push_back(std::move(item));
+    not_empty_.notify_one();
+  }
+
+  /**
+   * @brief Pop the oldest item, waits while the queue is empty. Returns false
+   * once the queue is closed and drained.
+   */
+  bool pop(T *item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+    if (items_.empty()) return false;
+    *item = std::move(items_.front());
+    items_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Mark the end of the stream
+   */
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    not_empty_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::deque<T> items_;
+  size_t capacity_{1};
+  bool closed_{false};
+};
+
+/**
+ * @brief PipelinedRunner runs the template method over a stream of documents,
+ * one thread per step.
+ *
+ * Each step is a stage connected to the next by a bounded queue, so document
+ * k + 1 can be in step 2 while document k is in step 3. Every stage handles
+ * documents in arrival order, so the steps of one document still run in the
+ * order of execute_algorithm(), and documents leave the pipeline in the order
+ * they entered it. Throughput is bounded by the slowest step instead of the
+ * sum of all steps.
+ */
+class PipelinedRunner {
+ public:
+  PipelinedRunner() = delete;
+
+  /**
+   * @brief Constructor
+   *
+   * @param analyzer Analyzer running the steps
+   * @param queue_capacity Maximum number of documents waiting between stages
+   */
+  explicit PipelinedRunner(const AbstractClass &analyzer,
+                           size_t queue_capacity = 4)
+      : analyzer_(analyzer), queue_capacity_(queue_capacity){};
+
+  PipelinedRunner(const PipelinedRunner &) = delete;
+  PipelinedRunner(PipelinedRunner &&) = delete;
+  PipelinedRunner operator=(const PipelinedRunner &) = delete;
+  PipelinedRunner operator=(PipelinedRunner &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~PipelinedRunner() = default;
+
+  /**
+   * @brief Run the algorithm on every document produced by `next`.
+   *
+   * @note `next` runs on the calling thread and returns null at the end of the
+   * stream. `done` receives every document, in input order, on the thread of
+   * the last stage. If a step or `done` throws, the later steps of that
+   * document are skipped, the stream is still drained, and the first exception
+   * is rethrown. If `next` throws, the documents already produced are drained
+   * before the exception is rethrown.
+   *
+   * @param next Document source
+   * @param done Document sink
+   */
+  template <typename Source, typename Sink>
+  void run(Source &&next, Sink &&done) const {
+    std::vector<std::unique_ptr<BoundedQueue<Item>>> queues;
+    for (size_t i = 0; i <= AbstractClass::cStepCount; ++i) {
+      queues.push_back(std::make_unique<BoundedQueue<Item>>(queue_capacity_));
+    }
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto fail = [&error_mutex, &error] {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) error = std::current_exception();
+    };
+
+    std::vector<std::thread> stages;
+    for (size_t step = 0; step < AbstractClass::cStepCount; ++step) {
+      stages.emplace_back([&, step] {
+        Item item;
+        while (queues[step]->pop(&item)) {
+          if (!item.failed) {
+            try {
+              analyzer_.execute_step(step, *item.document);
+            } catch (...) {
+              item.failed = true;
+              fail();
+            }
+          }
+          queues[step + 1]->push(std::move(item));
+        }
+        queues[step + 1]->close();
+      });
+    }
+    std::thread sink([&] {
+      Item item;
+      while (queues.back()->pop(&item)) {
+        try {
+          done(std::move(item.document));
+        } catch (...) {
+          fail();
+        }
+      }
+    });
+
+    try {
+      while (std::unique_ptr<Document> document = next()) {
+        queues.front()->push(Item{std::move(document), false});
+      }
+    } catch (...) {
+      fail();
+    }
+    queues.front()->close();
+
+    for (auto &stage : stages) {
+      stage.join();
+    }
+    sink.join();
+    if (error) std::rethrow_exception(error);
+  }
+
+ private:
+  /**
+   * @brief Document in flight, with whether one of its steps failed
+   */
+  struct Item {
+    std::unique_ptr<Document> document;
+    bool failed{false};
+  };
+
+  /**
+   * @brief Analyzer running the steps
+   */
+  const AbstractClass &analyzer_;
+
+  /**
+   * @brief Maximum number of documents waiting between stages
+   */
+  size_t queue_capacity_{4};
+};
+
+#endif  // BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_PIPELINED_RUNNER_H_
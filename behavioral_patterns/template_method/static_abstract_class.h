@@ -0,0 +1,176 @@
+#ifndef BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_STATIC_ABSTRACT_CLASS_H_
+#define BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_STATIC_ABSTRACT_CLASS_H_
+
+#include <type_traits>
+#include <utility>
+
+#include "template_method.h"
+
+/**
+ * @brief StaticAbstractClass is the compile-time (CRTP) counterpart of
+ * AbstractClass.
+ *
+ * The template method calls the steps on `static_cast<const Derived &>(*this)`
+ * instead of through the vtable, so the whole algorithm can inline into one
+ * function per concrete class. Concrete classes hide the steps they customize
+ * and must befriend their base when those steps are not public. Missing
+ * required steps (3 & 4) are compile errors.
+ *
+ * @note There is no common runtime interface: code working with several
+ * concrete classes has to be a template too.
+ */
+template <typename Derived>
+class StaticAbstractClass {
+ public:
+  /**
+   * @brief The template method defines the skeleton of an algorithm.
+   *
+   * @param document Document
+   */
+  void execute_algorithm(Document &document) const {
+    static_assert(decltype(has_step_3<Derived>(0))::value,
+                  "Concrete classes must implement execute_step_3");
+    static_assert(decltype(has_step_4<Derived>(0))::value,
+                  "Concrete classes must implement execute_step_4");
+
+    const Derived &self = static_cast<const Derived &>(*this);
+    self.execute_step_1(document);
+    self.execute_step_2(document);
+    self.execute_step_3(document);
+    self.execute_step_4(document);
+    self.execute_step_5(document);
+    self.execute_step_6(document);
+  }
+
+ protected:
+  /**
+   * @brief Constructor
+   */
+  StaticAbstractClass() = default;
+
+  StaticAbstractClass(const StaticAbstractClass &) = delete;
+  StaticAbstractClass(StaticAbstractClass &&) = delete;
+
+  /**
+   * @brief Destructor, not virtual: concrete classes are never deleted through
+   * their base.
+   */
+  ~StaticAbstractClass() = default;
+
+  /**
+   * Step 1 & 2 (Base operations)
+   */
+  void execute_step_1(Document &document) const {
+    report_step(document, cAbstractClassName, 1);
+  }
+  void execute_step_2(Document &document) const {
+    report_step(document, cAbstractClassName, 2);
+  }
+
+  /**
+   * Step 5 & 6 (overriding optional).
+   */
+  void execute_step_5(Document &document) const {}
+  void execute_step_6(Document &document) const {}
+
+ private:
+  template <typename T>
+  static auto has_step_3(int)
+      -> decltype(std::declval<const T &>().execute_step_3(
+                      std::declval<Document &>()),
+                  std::true_type{});
+  template <typename T>
+  static std::false_type has_step_3(...);
+
+  template <typename T>
+  static auto has_step_4(int)
+      -> decltype(std::declval<const T &>().execute_step_4(
+                      std::declval<Document &>()),
+                  std::true_type{});
+  template <typename T>
+  static std::false_type has_step_4(...);
+};
+
+/**
+ * @brief CRTP counterpart of ConcreteClass1
+ *
+ * This class implements required steps (3 & 4), and uses default
+ * implementation of step 5 & 6
+ */
+class StaticConcreteClass1 : public StaticAbstractClass<StaticConcreteClass1> {
+ public:
+  /**
+   * @brief Constructor
+   */
+  StaticConcreteClass1() = default;
+
+  StaticConcreteClass1(const StaticConcreteClass1 &) = delete;
+  StaticConcreteClass1(StaticConcreteClass1 &&) = delete;
+  StaticConcreteClass1 operator=(const StaticConcreteClass1 &) = delete;
+  StaticConcreteClass1 operator=(StaticConcreteClass1 &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~StaticConcreteClass1() = default;
+
+ protected:
+  friend class StaticAbstractClass<StaticConcreteClass1>;
+
+  /**
+   * Implement step 3 4 (required)
+   */
+  void execute_step_3(Document &document) const {
+    report_step(document, cConcreteClass1Name, 3);
+  }
+
+  void execute_step_4(Document &document) const {
+    report_step(document, cConcreteClass1Name, 4);
+  }
+};
+
+/**
+ * @brief CRTP counterpart of ConcreteClass2
+ *
+ * This class implements required steps (3 & 4), and some optional steps (5)
+ */
+class StaticConcreteClass2 : public StaticAbstractClass<StaticConcreteClass2> {
+ public:
+  /**
+   * @brief Constructor
+   */
+  StaticConcreteClass2() = default;
+
+  StaticConcreteClass2(const StaticConcreteClass2 &) = delete;
+  StaticConcreteClass2(StaticConcreteClass2 &&) = delete;
+  StaticConcreteClass2 operator=(const StaticConcreteClass2 &) = delete;
+  StaticConcreteClass2 operator=(StaticConcreteClass2 &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~StaticConcreteClass2() = default;
+
+ protected:
+  friend class StaticAbstractClass<StaticConcreteClass2>;
+
+  /**
+   * Implement step 3 4 (required)
+   */
+  void execute_step_3(Document &document) const {
+    report_step(document, cConcreteClass2Name, 3);
+  }
+
+  void execute_step_4(Document &document) const {
+    report_step(document, cConcreteClass2Name, 4);
+  }
+
+  /**
+   * Implement step 5
+   */
+  void execute_step_5(Document &document) const {
+    report_step(document, cConcreteClass2Name, 5);
+  }
+};
+
+#endif  // BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_STATIC_ABSTRACT_CLASS_H_
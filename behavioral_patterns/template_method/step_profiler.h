@@ -0,0 +1,157 @@
+#ifndef BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_STEP_PROFILER_H_
+#define BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_STEP_PROFILER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+#include "latency_histogram.h"
+
+/**
+ * @brief StepProfiler aggregates the latency of each step of the template
+ * method, per concrete class and per step.
+ *
+ * Analyzers opt in with AbstractClass::enable_profiling(). Each concrete class
+ * gets one profile, looked up once per analyzer, with one LatencyHistogram per
+ * step. report() and print() may run from any thread while analyzers are
+ * running.
+ */
+class StepProfiler {
+ public:
+  /**
+   * @brief Number of steps profiled per class
+   */
+  static constexpr size_t cSteps{6};
+
+  /**
+   * @brief Number of latency buckets, see LatencyHistogram
+   */
+  static constexpr size_t cBuckets{LatencyHistogram::cBuckets};
+
+  /**
+   * @brief Aggregated latency of one step of one concrete class
+   */
+  struct Entry : LatencyHistogram::Snapshot {
+    std::string class_name;
+    size_t step{0};
+  };
+
+  /**
+   * @brief Counters of one concrete class
+   */
+  class ClassProfile {
+   public:
+    /**
+     * @brief Record one run of `step` (1-based) lasting `ns`
+     */
+    void record(size_t step, uint64_t ns) { steps_[step - 1].record(ns); }
+
+   private:
+    friend class StepProfiler;
+
+    std::array<LatencyHistogram, cSteps> steps_;
+  };
+
+  /**
+   * @brief Constructor
+   */
+  StepProfiler() = default;
+
+  StepProfiler(const StepProfiler &) = delete;
+  StepProfiler(StepProfiler &&) = delete;
+  StepProfiler operator=(const StepProfiler &) = delete;
+  StepProfiler operator=(StepProfiler &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~StepProfiler() = default;
+
+  /**
+   * @brief Profile of the concrete class `type`, created on first use
+   */
+  ClassProfile *profile_of(const std::type_info &type) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &named = profiles_[std::type_index(type)];
+    if (!named.second) {
+      named.first = demangle(type.name());
+      named.second = std::make_unique<ClassProfile>();
+    }
+    return named.second.get();
+  }
+
+  /**
+   * @brief Snapshot of every step that ran at least once, by class then step
+   */
+  std::vector<Entry> report() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Entry> entries;
+    for (const auto &profile : profiles_) {
+      for (size_t step = 0; step < cSteps; ++step) {
+        Entry entry;
+        static_cast<LatencyHistogram::Snapshot &>(entry) =
+            profile.second.second->steps_[step].snapshot();
+        entry.class_name = profile.second.first;
+        entry.step = step + 1;
+        if (entry.calls) entries.push_back(std::move(entry));
+      }
+    }
+    return entries;
+  }
+
+  /**
+   * @brief Print the report as a table
+   */
+  void print(FILE *out) const {
+    fprintf(out, "%-24s %4s %10s %12s %10s %10s\n", "class", "step", "calls",
+            "mean_ns", "p50_ns<", "p99_ns<");
+    for (const Entry &entry : report()) {
+      fprintf(out, "%-24s %4zu %10llu %12.1f %10llu %10llu\n",
+              entry.class_name.c_str(), entry.step,
+              static_cast<unsigned long long>(entry.calls),
+              static_cast<double>(entry.total_ns) / entry.calls,
+              static_cast<unsigned long long>(entry.quantile_ns(0.5)),
+              static_cast<unsigned long long>(entry.quantile_ns(0.99)));
+    }
+  }
+
+ private:
+  /**
+   * @brief Readable class name
+   */
+  static std::string demangle(const char *name) {
+#if defined(__GNUG__)
+    int status = 0;
+    char *readable = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status == 0 && readable) {
+      std::string result(readable);
+      free(readable);
+      return result;
+    }
+#endif
+    return name;
+  }
+
+  /**
+   * @brief Profiles with their class name, guarded by `mutex_`
+   */
+  mutable std::mutex mutex_;
+  std::map<std::type_index,
+           std::pair<std::string, std::unique_ptr<ClassProfile>>>
+      profiles_;
+};
+
+#endif  // BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_STEP_PROFILER_H_
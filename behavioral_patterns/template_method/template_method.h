@@ -0,0 +1,466 @@
+#ifndef BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_TEMPLATE_METHOD_H_
+#define BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_TEMPLATE_METHOD_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+
+#include "span.h"
+#include "step_profiler.h"
+
+/**
+ * @brief AbstractClass name
+ */
+static const char *cAbstractClassName{"AbstractClass"};
+
+/**
+ * @brief ConcreteClass1 name
+ */
+static const char *cConcreteClass1Name{"ConcreteClass1"};
+
+/**
+ * @brief ConcreteClass2 name
+ */
+static const char *cConcreteClass2Name{"ConcreteClass2"};
+
+/**
+ * @brief Document analysed by the algorithm. Steps read it and may record
+ * their intermediate results in it.
+ */
+struct Document {
+  /**
+   * @brief Document name
+   */
+  std::string name;
+
+  /**
+   * @brief Where steps report their progress, nullptr to keep them quiet
+   */
+  FILE *log{stdout};
+
+  /**
+   * @brief Contents, viewed rather than copied (e.g. from a MappedFile), which
+   * must outlive the algorithm
+   */
+  std::string_view content{};
+};
+
+/**
+ * @brief Report that `class_name` ran `step` on `document`
+ */
+inline void report_step(const Document &document, const char *class_name,
+                        int step) {
+  if (!document.log) return;
+  if (document.content.empty()) {
+    fprintf(document.log, "%s: Implements step %d on %s\n", class_name, step,
+            document.name.c_str());
+  } else {
+    fprintf(document.log, "%s: Implements step %d on %s (%zu bytes)\n",
+            class_name, step, document.name.c_str(), document.content.size());
+  }
+}
+
+class CheckpointedRunner;
+class ParallelStepRunner;
+class PipelinedRunner;
+
+/**
+ * @brief The Abstract Class defines a template method that contains a skeleton
+ * of some algorithm, composed of calls to (usually) abstract primitive
+ * operations.
+ *
+ * Concrete subclasses should implement these operations, but leave the template
+ * method itself intact.
+ */
+class AbstractClass {
+ public:
+  /**
+   * @brief Constructor
+   */
+  AbstractClass() = default;
+
+  AbstractClass(const AbstractClass &) = delete;
+  AbstractClass(AbstractClass &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~AbstractClass() = default;
+
+  /**
+   * @brief Number of steps of the algorithm
+   */
+  static constexpr size_t cStepCount{6};
+
+  /**
+   * @brief Bits of the optional steps in a skip mask
+   */
+  static constexpr unsigned cStep5{1u << 4};
+  static constexpr unsigned cStep6{1u << 5};
+
+  /**
+   * @brief The template method defines the skeleton of an algorithm.
+   *
+   * @note Optional steps known to keep their empty default are not called.
+   *
+   * @param document Document
+   */
+  void execute_algorithm(Document &document) const {
+    if (profile_) return execute_algorithm_profiled(document);
+
+    this->execute_step_1(document);
+    this->execute_step_2(document);
+    this->execute_step_3(document);
+    this->execute_step_4(document);
+    if (!(skipped_steps_ & cStep5)) this->execute_step_5(document);
+    if (!(skipped_steps_ & cStep6)) this->execute_step_6(document);
+  }
+
+  /**
+   * @brief Time every step of execute_algorithm() into `profiler`, under the
+   * concrete class of this analyzer.
+   */
+  void enable_profiling(StepProfiler &profiler) {
+    profile_ = profiler.profile_of(typeid(*this));
+  }
+
+  /**
+   * @brief Stop timing the steps
+   */
+  void disable_profiling() { profile_ = nullptr; }
+
+  /**
+   * @brief Batch form of the template method: runs step 1 on every document,
+   * then step 2 on every document, and so on.
+   *
+   * Each step's code and data stay hot in cache across the batch, and the
+   * virtual call of a step happens once per batch. Steps of one document still
+   * run in the order of execute_algorithm().
+   *
+   * @param documents Documents
+   */
+  void execute_algorithm_batch(Span<Document> documents) const {
+    this->execute_step_1_batch(documents);
+    this->execute_step_2_batch(documents);
+    this->execute_step_3_batch(documents);
+    this->execute_step_4_batch(documents);
+    if (!(skipped_steps_ & cStep5)) this->execute_step_5_batch(documents);
+    if (!(skipped_steps_ & cStep6)) this->execute_step_6_batch(documents);
+  }
+
+ protected:
+  /**
+   * @brief Constructor
+   *
+   * @param skipped_steps Optional steps left to their empty default, which the
+   * template method can skip (see HookAwareClass)
+   */
+  explicit AbstractClass(unsigned skipped_steps)
+      : skipped_steps_(skipped_steps){};
+
+  /**
+   * Step 1 & 2 (Base operations)
+   */
+  void execute_step_1(Document &document) const {
+    report_step(document, cAbstractClassName, 1);
+  }
+  void execute_step_2(Document &document) const {
+    report_step(document, cAbstractClassName, 2);
+  }
+
+  /**
+   * Step 3 & 4 (overriding required).
+   */
+  virtual void execute_step_3(Document &document) const = 0;
+  virtual void execute_step_4(Document &document) const = 0;
+
+  /**
+   * Step 3 & 4 (overriding optional).
+   */
+  virtual void execute_step_5(Document &document) const {}
+  virtual void execute_step_6(Document &document) const {}
+
+  /**
+   * @brief Steps that must complete before the step at `index` (0-based)
+   * starts, as a mask where bit `i` stands for the step at index `i`. Only
+   * earlier steps may be listed.
+   *
+   * @note Used by ParallelStepRunner, which runs steps whose dependencies are
+   * met concurrently. By default each step depends on the previous one, so the
+   * steps run in sequence. Concrete classes relax it for steps that do not
+   * touch each other's data.
+   */
+  virtual unsigned step_dependencies(size_t index) const {
+    return index ? 1u << (index - 1) : 0u;
+  }
+
+  /**
+   * @brief Serialization hooks of CheckpointedRunner: write to `out` the
+   * intermediate state the steps done so far left in `document`, and read it
+   * back from `in` on resume. Return false on failure.
+   *
+   * @note By default steps keep no state besides the document name.
+   */
+  virtual bool save_state(const Document &document, FILE *out) const {
+    return true;
+  }
+  virtual bool load_state(Document &document, FILE *in) const { return true; }
+
+  /**
+   * Batch forms of the steps, used by execute_algorithm_batch(). By default
+   * they run the step on each document in turn. Concrete classes can override
+   * the batch form of steps 3 to 6 with a loop that does not go through the
+   * vtable, or with a vectorized implementation.
+   */
+  void execute_step_1_batch(Span<Document> documents) const {
+    for (Document &document : documents) this->execute_step_1(document);
+  }
+  void execute_step_2_batch(Span<Document> documents) const {
+    for (Document &document : documents) this->execute_step_2(document);
+  }
+  virtual void execute_step_3_batch(Span<Document> documents) const {
+    for (Document &document : documents) this->execute_step_3(document);
+  }
+  virtual void execute_step_4_batch(Span<Document> documents) const {
+    for (Document &document : documents) this->execute_step_4(document);
+  }
+  virtual void execute_step_5_batch(Span<Document> documents) const {
+    for (Document &document : documents) this->execute_step_5(document);
+  }
+  virtual void execute_step_6_batch(Span<Document> documents) const {
+    for (Document &document : documents) this->execute_step_6(document);
+  }
+
+ private:
+  friend class CheckpointedRunner;
+  friend class ParallelStepRunner;
+  friend class PipelinedRunner;
+
+  /**
+   * @brief Execute the step at `index` (0-based) on its own, for runners
+   * spreading the algorithm over several threads.
+   */
+  void execute_step(size_t index, Document &document) const {
+    if (skipped_steps_ & (1u << index)) return;
+    switch (index) {
+      case 0:
+        return this->execute_step_1(document);
+      case 1:
+        return this->execute_step_2(document);
+      case 2:
+        return this->execute_step_3(document);
+      case 3:
+        return this->execute_step_4(document);
+      case 4:
+        return this->execute_step_5(document);
+      case 5:
+        return this->execute_step_6(document);
+    }
+  }
+
+  /**
+   * @brief execute_algorithm(), timing each step
+   */
+  void execute_algorithm_profiled(Document &document) const {
+    time_step(1, [&] { this->execute_step_1(document); });
+    time_step(2, [&] { this->execute_step_2(document); });
+    time_step(3, [&] { this->execute_step_3(document); });
+    time_step(4, [&] { this->execute_step_4(document); });
+    if (!(skipped_steps_ & cStep5)) {
+      time_step(5, [&] { this->execute_step_5(document); });
+    }
+    if (!(skipped_steps_ & cStep6)) {
+      time_step(6, [&] { this->execute_step_6(document); });
+    }
+  }
+
+  /**
+   * @brief Run `step` and record its latency
+   */
+  template <typename Step>
+  void time_step(size_t index, Step &&step) const {
+    const auto start = std::chrono::steady_clock::now();
+    step();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+    profile_->record(index, static_cast<uint64_t>(elapsed.count()));
+  }
+
+  /**
+   * @brief Optional steps to skip
+   */
+  const unsigned skipped_steps_{0};
+
+  /**
+   * @brief Profile receiving step latencies, null when profiling is disabled
+   */
+  StepProfiler::ClassProfile *profile_{nullptr};
+};
+
+/**
+ * @brief HookAwareClass resolves, once per subclass and at compile time, which
+ * optional steps keep the empty default, so that the template method skips
+ * them instead of paying a virtual call for nothing. A step is only skipped
+ * when both its per-document form and its batch form keep their default.
+ *
+ * Concrete classes derive from HookAwareClass<Self> instead of AbstractClass,
+ * and must be final: the steps are resolved for Self, so a subclass overriding
+ * an empty hook of Self would have it skipped.
+ *
+ * @note Detection: `&Derived::execute_step_N` only names AbstractClass's
+ * default (and has type `void (AbstractClass::*)(Document &) const`) when
+ * Derived does not override the step. A public override gives another type, a
+ * protected or private one cannot be named from here. In both cases the step
+ * is kept. `&Derived::execute_step_N_batch` is checked the same way.
+ */
+template <typename Derived>
+class HookAwareClass : public AbstractClass {
+ protected:
+  /**
+   * @brief Constructor
+   */
+  HookAwareClass() : AbstractClass(skipped_steps()) {
+    static_assert(std::is_final<Derived>::value,
+                  "HookAwareClass<Derived>: Derived must be final");
+  }
+
+ private:
+  using Step = void (AbstractClass::*)(Document &) const;
+  using BatchStep = void (AbstractClass::*)(Span<Document>) const;
+
+  template <typename T>
+  static auto default_step_5(int)
+      -> std::is_same<decltype(&T::execute_step_5), Step>;
+  template <typename T>
+  static std::false_type default_step_5(...);
+
+  template <typename T>
+  static auto default_step_6(int)
+      -> std::is_same<decltype(&T::execute_step_6), Step>;
+  template <typename T>
+  static std::false_type default_step_6(...);
+
+  template <typename T>
+  static auto default_step_5_batch(int)
+      -> std::is_same<decltype(&T::execute_step_5_batch), BatchStep>;
+  template <typename T>
+  static std::false_type default_step_5_batch(...);
+
+  template <typename T>
+  static auto default_step_6_batch(int)
+      -> std::is_same<decltype(&T::execute_step_6_batch), BatchStep>;
+  template <typename T>
+  static std::false_type default_step_6_batch(...);
+
+  static constexpr unsigned skipped_steps() {
+    return (decltype(default_step_5<Derived>(0))::value &&
+                    decltype(default_step_5_batch<Derived>(0))::value
+                ? cStep5
+                : 0u) |
+           (decltype(default_step_6<Derived>(0))::value &&
+                    decltype(default_step_6_batch<Derived>(0))::value
+                ? cStep6
+                : 0u);
+  }
+};
+
+/**
+ * @brief Concrete class 2
+ *
+ * This class overrides required steps (3 & 4), and uses default implementation
+ * of step 5 & 6
+ */
+class ConcreteClass1 final : public HookAwareClass<ConcreteClass1> {
+ public:
+  /**
+   * @brief Constructor
+   */
+  ConcreteClass1() = default;
+
+  ConcreteClass1(const ConcreteClass1 &) = delete;
+  ConcreteClass1(ConcreteClass1 &&) = delete;
+  ConcreteClass1 operator=(const ConcreteClass1 &) = delete;
+  ConcreteClass1 operator=(ConcreteClass1 &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~ConcreteClass1() = default;
+
+ protected:
+  /**
+   * Override step 3 4 (required)
+   */
+  void execute_step_3(Document &document) const override {
+    report_step(document, cConcreteClass1Name, 3);
+  }
+
+  void execute_step_4(Document &document) const override {
+    report_step(document, cConcreteClass1Name, 4);
+  }
+
+  /**
+   * Override the batch form of step 3 with a loop calling the step directly
+   */
+  void execute_step_3_batch(Span<Document> documents) const override {
+    for (Document &document : documents) {
+      ConcreteClass1::execute_step_3(document);
+    }
+  }
+};
+
+/**
+ * @brief Concrete class 2
+ *
+ * This class overrides required steps (3 & 4), and some optional steps (5)
+ */
+class ConcreteClass2 final : public HookAwareClass<ConcreteClass2> {
+ public:
+  /**
+   * @brief Constructor
+   */
+  ConcreteClass2() = default;
+
+  ConcreteClass2(const ConcreteClass2 &) = delete;
+  ConcreteClass2(ConcreteClass2 &&) = delete;
+  ConcreteClass2 operator=(const ConcreteClass2 &) = delete;
+  ConcreteClass2 operator=(ConcreteClass2 &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~ConcreteClass2() = default;
+
+ protected:
+  /**
+   * Override step 3 4 (required)
+   */
+  void execute_step_3(Document &document) const override {
+    report_step(document, cConcreteClass2Name, 3);
+  }
+
+  void execute_step_4(Document &document) const override {
+    report_step(document, cConcreteClass2Name, 4);
+  }
+
+  /**
+   * Override step 5
+   */
+  void execute_step_5(Document &document) const override {
+    report_step(document, cConcreteClass2Name, 5);
+  }
+
+  /**
+   * Steps 5 & 6 only need the result of step 4, not each other
+   */
+  unsigned step_dependencies(size_t index) const override {
+    return index == 5 ? 1u << 3 : AbstractClass::step_dependencies(index);
+  }
+};
+
+#endif  // BEHAVIORAL_PATTERNS_TEMPLATE_METHOD_TEMPLATE_METHOD_H_
@@ -0,0 +1,199 @@
+#ifndef STRUCTURAL_PATTERNS_COMMON_ROPE_H_
+#define STRUCTURAL_PATTERNS_COMMON_ROPE_H_
+
+#include <cerrno>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Immutable string made of shared pieces: concatenation links the two
+ * ropes in O(1) instead of copying them.
+ *
+ * Results assembled from many pieces are copied once, when flattened, or never
+ * when written piece by piece, so building them is linear in their size
+ * whatever the nesting depth.
+ *
+ * @note Shared by the composite and decorator examples.
+ */
+class Rope {
+ public:
+  /**
+   * @brief Constructor, empty rope
+   */
+  Rope() = default;
+
+  /**
+   * @brief Constructor, single piece
+   *
+   * @param text Text
+   */
+  Rope(std::string text)
+      : root_(text.empty() ? nullptr
+                           : std::make_shared<const Node>(std::move(text))){};
+  Rope(const char *text) : Rope(std::string(text)){};
+
+  /**
+   * @brief Concatenation, O(1)
+   */
+  friend Rope operator+(const Rope &left, const Rope &right) {
+    if (!left.root_) return right;
+    if (!right.root_) return left;
+    return Rope(std::make_shared<const Node>(left.root_, right.root_));
+  }
+  Rope &operator+=(const Rope &right) { return *this = *this + right; }
+
+  /**
+   * @brief Length in bytes
+   */
+  size_t size() const { return root_ ? root_->size : 0; }
+  bool empty() const { return !root_; }
+
+  /**
+   * @brief Call `visit(const std::string &)` on every piece, in order
+   */
+  template <typename Visit>
+  void for_each_piece(Visit &&visit) const {
+    // Explicit stack: ropes of deep structures are deep too
+    std::vector<const Node *> pending;
+    if (root_) pending.push_back(root_.get());
+    while (!pending.empty()) {
+      const Node *node = pending.back();
+      pending.pop_back();
+      if (node->left) {
+        pending.push_back(node->right.get());
+        pending.push_back(node->left.get());
+      } else {
+        visit(node->text);
+      }
+    }
+  }
+
+  /**
+   * @brief Contiguous copy, made in a single allocation
+   */
+  std::string flatten() const {
+    std::string result;
+    result.reserve(size());
+    for_each_piece([&result](const std::string &piece) { result += piece; });
+    return result;
+  }
+
+  /**
+   * @brief Write every piece to `out`
+   */
+  friend std::ostream &operator<<(std::ostream &out, const Rope &rope) {
+    rope.for_each_piece([&out](const std::string &piece) { out << piece; });
+    return out;
+  }
+
+#if defined(__unix__) || defined(__APPLE__)
+  /**
+   * @brief Write every piece to file descriptor `fd` with scatter/gather I/O
+   * (writev), without flattening. Returns false on error.
+   */
+  bool write(int fd) const {
+    std::vector<iovec> pieces;
+    pieces.reserve(cMaxPieces);
+    bool ok = true;
+    for_each_piece([&](const std::string &piece) {
+      pieces.push_back({const_cast<char *>(piece.data()), piece.size()});
+      if (pieces.size() == cMaxPieces) {
+        ok = ok && write_all(fd, &pieces);
+        pieces.clear();
+      }
+    });
+    return ok && write_all(fd, &pieces);
+  }
+#endif
+
+ private:
+  /**
+   * @brief Piece (no children) or concatenation of two non-empty ropes
+   */
+  struct Node {
+    explicit Node(std::string text)
+        : text(std::move(text)), size(this->text.size()){};
+    Node(std::shared_ptr<const Node> left, std::shared_ptr<const Node> right)
+        : left(std::move(left)), right(std::move(right)) {
+      size = this->left->size + this->right->size;
+    }
+
+    /**
+     * @brief Destructor, releases the nodes only this one owns with an
+     * explicit stack: a recursive release would take a stack frame per level
+     * of a deep rope.
+     */
+    ~Node() {
+      std::vector<std::shared_ptr<const Node>> pending;
+      auto take = [&pending](std::shared_ptr<const Node> &child) {
+        if (child && child.use_count() == 1) {
+          pending.push_back(std::move(child));
+        }
+      };
+      take(left);
+      take(right);
+      while (!pending.empty()) {
+        std::shared_ptr<const Node> node = std::move(pending.back());
+        pending.pop_back();
+        take(node->left);
+        take(node->right);
+      }
+    }
+
+    std::string text;
+    // Mutable so that ~Node() can take the children of the nodes it releases
+    mutable std::shared_ptr<const Node> left;
+    mutable std::shared_ptr<const Node> right;
+    size_t size{0};
+  };
+
+  explicit Rope(std::shared_ptr<const Node> root) : root_(std::move(root)){};
+
+#if defined(__unix__) || defined(__APPLE__)
+  /**
+   * @brief Pieces written per writev() call
+   */
+  static constexpr size_t cMaxPieces{64};
+
+  /**
+   * @brief writev() every byte of `pieces`, resuming after partial writes
+   */
+  static bool write_all(int fd, std::vector<iovec> *pieces) {
+    iovec *next = pieces->data();
+    size_t count = pieces->size();
+    while (count) {
+      ssize_t written = writev(fd, next, static_cast<int>(count));
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        return false;
+      }
+      while (count && static_cast<size_t>(written) >= next->iov_len) {
+        written -= next->iov_len;
+        ++next;
+        --count;
+      }
+      if (count) {
+        next->iov_base = static_cast<char *>(next->iov_base) + written;
+        next->iov_len -= written;
+      }
+    }
+    return true;
+  }
+#endif
+
+  /**
+   * @brief Root node, nullptr when empty
+   */
+  std::shared_ptr<const Node> root_;
+};
+
+#endif  // STRUCTURAL_PATTERNS_COMMON_ROPE_H_
@@ -0,0 +1,454 @@
+#ifndef STRUCTURAL_PATTERNS_COMPOSITE_BULK_TREE_H_
+#define STRUCTURAL_PATTERNS_COMPOSITE_BULK_TREE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "composite.h"
+#include "rope.h"
+
+/**
+ * @brief Node of a BulkTree: behaves as a Leaf without children and as a
+ * Composite otherwise. Its children live in the contiguous storage of the
+ * tree, so it cannot be edited.
+ */
+class BulkNode : public Component {
+ public:
+  /**
+   * @brief Constructor
+   */
+  BulkNode() = default;
+
+  BulkNode(const BulkNode &) = delete;
+  BulkNode(BulkNode &&) = delete;
+  BulkNode operator=(const BulkNode &) = delete;
+  BulkNode operator=(BulkNode &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~BulkNode() = default;
+
+  /**
+   * @brief Bulk-loaded trees are built at once, see BulkTree.
+   */
+  void add(Component *component) override {
+    throw std::logic_error("Bulk-loaded trees cannot be edited");
+  }
+  void remove(Component *component) override {
+    throw std::logic_error("Bulk-loaded trees cannot be edited");
+  }
+
+  /**
+   * @brief Check if the object is composite
+   *
+   * @return bool
+   */
+  bool is_composite() const override { return count_ != 0; }
+
+  /**
+   * @brief Same result as Leaf or Composite
+   */
+  Rope execute_rope() const override {
+    if (!count_) return "Leaf";
+    Rope result("Branch(");
+    for (size_t i = 0; i < count_; ++i) {
+      if (i) result += "+";
+      result += children_[i]->execute_rope();
+    }
+    return result + ")";
+  }
+
+  /**
+   * @brief Children getters
+   */
+  Component *const *begin() const { return children_; }
+  Component *const *end() const { return children_ + count_; }
+  size_t size() const { return count_; }
+
+ private:
+  friend class BulkTree;
+
+  /**
+   * @brief Children, in the storage of the tree
+   */
+  Component *const *children_{nullptr};
+  size_t count_{0};
+};
+
+/**
+ * @brief BulkTree builds a whole hierarchy at once, in parallel, from a parent
+ * array or a (parent, child) edge list.
+ *
+ * Instead of one add() per child, the loader counts the children of every
+ * node, turns the counts into offsets with a prefix sum, then scatters every
+ * child into one contiguous array where the children of a node are adjacent,
+ * in index order. Each phase is split evenly between the threads, which are
+ * started once per build and reused from phase to phase.
+ *
+ * @note The input must be a forest: a parent that is directly or indirectly
+ * its own child is not detected and leaves a cycle that execute() never
+ * leaves.
+ */
+class BulkTree {
+ public:
+  /**
+   * @brief Parent of a root in a parent array
+   */
+  static constexpr size_t cNoParent{SIZE_MAX};
+
+  BulkTree() = delete;
+
+  /**
+   * @brief Constructor, throws std::invalid_argument on a parent out of range
+   *
+   * @param parents Parent of each node, cNoParent for roots
+   * @param threads Number of threads
+   */
+  explicit BulkTree(const std::vector<size_t> &parents,
+                    size_t threads = std::thread::hardware_concurrency())
+      : size_(parents.size()), threads_(threads ? threads : 1) {
+    workers_ = std::make_unique<Workers>(shares_of(size_));
+    build(parents);
+    workers_.reset();
+  }
+
+  /**
+   * @brief Constructor, throws std::invalid_argument on a node out of range or
+   * with several parents
+   *
+   * @param nodes Number of nodes
+   * @param edges (parent, child) edges
+   * @param threads Number of threads
+   */
+  BulkTree(size_t nodes, const std::vector<std::pair<size_t, size_t>> &edges,
+           size_t threads = std::thread::hardware_concurrency())
+      : size_(nodes), threads_(threads ? threads : 1) {
+    workers_ = std::make_unique<Workers>(
+        shares_of(std::max(size_, edges.size())));
+    build(parents_of(edges));
+    workers_.reset();
+  }
+
+  BulkTree(const BulkTree &) = delete;
+  BulkTree(BulkTree &&) = delete;
+  BulkTree operator=(const BulkTree &) = delete;
+  BulkTree operator=(BulkTree &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~BulkTree() = default;
+
+  /**
+   * @brief Number of nodes
+   */
+  size_t size() const { return size_; }
+
+  /**
+   * @brief Node `index`
+   */
+  BulkNode *node(size_t index) const { return &nodes_[index]; }
+
+  /**
+   * @brief Nodes without a parent, in index order
+   */
+  const std::vector<size_t> &roots() const { return roots_; }
+
+ private:
+  /**
+   * @brief Threads kept for the duration of a build. run(shares, body) calls
+   * `body(t)` for every share t in [0, shares) on the workers and the calling
+   * thread, and returns once every share is done.
+   */
+  class Workers {
+   public:
+    /**
+     * @brief Constructor, starts `threads - 1` workers
+     */
+    explicit Workers(size_t threads) {
+      try {
+        for (size_t t = 1; t < threads; ++t) {
+          threads_.emplace_back([this] { work(); });
+        }
+      } catch (...) {
+        stop();
+        throw;
+      }
+    }
+
+    Workers(const Workers &) = delete;
+    Workers(Workers &&) = delete;
+    Workers operator=(const Workers &) = delete;
+    Workers operator=(Workers &&) = delete;
+
+    /**
+     * @brief Destructor, stops and joins the workers
+     */
+    ~Workers() { stop(); }
+
+    /**
+     * @brief Run one phase
+     */
+    void run(size_t shares, const std::function<void(size_t)> &body) {
+      if (threads_.empty() || shares < 2) {
+        for (size_t t = 0; t < shares; ++t) body(t);
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        body_ = &body;
+        shares_ = shares;
+        next_ = 0;
+        left_ = shares;
+        ++phase_;
+      }
+      wake_.notify_all();
+      take_shares();
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_.wait(lock, [this] { return !left_; });
+    }
+
+   private:
+    /**
+     * @brief Stop and join the workers
+     */
+    void stop() {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+      }
+      wake_.notify_all();
+      for (auto &thread : threads_) thread.join();
+    }
+
+    /**
+     * @brief Worker loop: help with every new phase until stopped
+     */
+    void work() {
+      size_t seen = 0;
+      for (;;) {
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          wake_.wait(lock, [this, seen] { return stop_ || phase_ != seen; });
+          if (stop_) return;
+          seen = phase_;
+        }
+        take_shares();
+      }
+    }
+
+    /**
+     * @brief Run shares of the current phase until none is left to take
+     */
+    void take_shares() {
+      for (;;) {
+        const std::function<void(size_t)> *body;
+        size_t t;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (next_ == shares_) return;
+          body = body_;
+          t = next_++;
+        }
+        (*body)(t);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!--left_) done_.notify_all();
+      }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)> *body_{nullptr};
+    size_t phase_{0};
+    size_t shares_{0};
+    size_t next_{0};
+    size_t left_{0};
+    bool stop_{false};
+  };
+
+  /**
+   * @brief Run `body(begin, end)` over [0, n) split evenly between the
+   * threads
+   */
+  template <typename Body>
+  void parallel_for(size_t n, Body &&body) const {
+    const size_t shares = shares_of(n);
+    run_shares(shares, [&body, n, shares](size_t t) {
+      body(n * t / shares, n * (t + 1) / shares);
+    });
+  }
+
+  /**
+   * @brief Number of threads worth splitting `n` items between
+   */
+  size_t shares_of(size_t n) const {
+    return std::min(threads_, std::max<size_t>(n / cMinShare, 1));
+  }
+
+  /**
+   * @brief Parent array of `edges`
+   */
+  std::vector<size_t> parents_of(
+      const std::vector<std::pair<size_t, size_t>> &edges) const {
+    std::vector<std::atomic<size_t>> claimed(size_);
+    parallel_for(size_, [&claimed](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        claimed[i].store(cNoParent, std::memory_order_relaxed);
+      }
+    });
+
+    std::atomic<bool> invalid{false};
+    parallel_for(edges.size(), [&](size_t begin, size_t end) {
+      for (size_t e = begin; e < end; ++e) {
+        const size_t parent = edges[e].first, child = edges[e].second;
+        size_t none = cNoParent;
+        if (parent >= size_ || child >= size_ ||
+            !claimed[child].compare_exchange_strong(
+                none, parent, std::memory_order_relaxed)) {
+          invalid.store(true, std::memory_order_relaxed);
+        }
+      }
+    });
+    if (invalid) {
+      throw std::invalid_argument("Edge out of range or second parent");
+    }
+
+    std::vector<size_t> parents(size_);
+    parallel_for(size_, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        parents[i] = claimed[i].load(std::memory_order_relaxed);
+      }
+    });
+    return parents;
+  }
+
+  /**
+   * @brief Build the nodes and their children from `parents`
+   */
+  void build(const std::vector<size_t> &parents) {
+    // Count the children of each node
+    std::vector<std::atomic<size_t>> cursors(size_);
+    std::atomic<bool> invalid{false};
+    parallel_for(size_, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        if (parents[i] == cNoParent) continue;
+        if (parents[i] >= size_ || parents[i] == i) {
+          invalid.store(true, std::memory_order_relaxed);
+        } else {
+          cursors[parents[i]].fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+    if (invalid) throw std::invalid_argument("Parent out of range");
+
+    // Exclusive prefix sum of the counts: offset of each node's children.
+    // Each share sums its counts, the share totals are scanned, then each
+    // share writes its offsets.
+    offsets_.resize(size_ + 1);
+    const size_t shares = shares_of(size_);
+    std::vector<size_t> totals(shares + 1, 0);
+    auto share_of = [this, shares](size_t t) { return size_ * t / shares; };
+    run_shares(shares, [&](size_t t) {
+      size_t total = 0;
+      for (size_t i = share_of(t); i < share_of(t + 1); ++i) {
+        total += cursors[i].load(std::memory_order_relaxed);
+      }
+      totals[t + 1] = total;
+    });
+    for (size_t t = 0; t < shares; ++t) totals[t + 1] += totals[t];
+    run_shares(shares, [&](size_t t) {
+      size_t offset = totals[t];
+      for (size_t i = share_of(t); i < share_of(t + 1); ++i) {
+        const size_t count = cursors[i].load(std::memory_order_relaxed);
+        offsets_[i] = offset;
+        cursors[i].store(offset, std::memory_order_relaxed);
+        offset += count;
+      }
+    });
+    offsets_[size_] = totals[shares];
+
+    // Scatter each child into the slots of its parent
+    nodes_.reset(new BulkNode[size_]);
+    children_.reset(new Component *[offsets_[size_]]);
+    parallel_for(size_, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        if (parents[i] == cNoParent) continue;
+        const size_t slot =
+            cursors[parents[i]].fetch_add(1, std::memory_order_relaxed);
+        children_[slot] = &nodes_[i];
+      }
+    });
+
+    // Restore index order among siblings, link every node
+    parallel_for(size_, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        BulkNode &node = nodes_[i];
+        node.children_ = &children_[offsets_[i]];
+        node.count_ = offsets_[i + 1] - offsets_[i];
+        std::sort(&children_[offsets_[i]], &children_[offsets_[i + 1]]);
+        node.set_parent(parents[i] == cNoParent ? nullptr
+                                                : &nodes_[parents[i]]);
+      }
+    });
+    for (size_t i = 0; i < size_; ++i) {
+      if (parents[i] == cNoParent) roots_.push_back(i);
+    }
+  }
+
+  /**
+   * @brief Run `body(t)` for every share t in [0, shares) on the workers
+   */
+  template <typename Body>
+  void run_shares(size_t shares, Body &&body) const {
+    workers_->run(shares, body);
+  }
+
+  /**
+   * @brief Fewest items worth a thread of their own
+   */
+  static constexpr size_t cMinShare{4096};
+
+  /**
+   * @brief Number of nodes, and of threads building them
+   */
+  const size_t size_;
+  const size_t threads_;
+
+  /**
+   * @brief Threads running the phases of the build, only while building
+   */
+  std::unique_ptr<Workers> workers_;
+
+  /**
+   * @brief Nodes
+   */
+  std::unique_ptr<BulkNode[]> nodes_;
+
+  /**
+   * @brief Children of every node, those of node i from offsets_[i] to
+   * offsets_[i + 1]
+   */
+  std::unique_ptr<Component *[]> children_;
+  std::vector<size_t> offsets_;
+
+  /**
+   * @brief Nodes without a parent
+   */
+  std::vector<size_t> roots_;
+};
+
+#endif  // STRUCTURAL_PATTERNS_COMPOSITE_BULK_TREE_H_
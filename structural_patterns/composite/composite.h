@@ -0,0 +1,209 @@
+#ifndef STRUCTURAL_PATTERNS_COMPOSITE_COMPOSITE_H_
+#define STRUCTURAL_PATTERNS_COMPOSITE_COMPOSITE_H_
+
+#include <list>
+#include <string>
+
+#include "rope.h"
+
+/**
+ * @brief The base Component class declares common operations for both simple
+ * and complex objects of a composition.
+ */
+class Component {
+ public:
+  /**
+   * @brief Constructor
+   */
+  Component() = default;
+
+  Component(const Component &) = delete;
+  Component(Component &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~Component() = default;
+
+  /**
+   * @note In some cases, it would be beneficial to define the child-management
+   * operations right in the base Component class. This way, you won't need to
+   * expose any concrete component classes to the client code, even during the
+   * object tree assembly. The downside is that these methods will be empty for
+   * the leaf-level components. => CONS
+   */
+  virtual void add(Component *component) {}
+  virtual void remove(Component *component) {}
+
+  /**
+   * @brief Check if object is composite
+   */
+  virtual bool is_composite() const { return false; }
+
+  /**
+   * @brief Result of the component, execute_rope() flattened. Final, so that
+   * execute_rope() is the only behavior subclasses override and composites
+   * never bypass it.
+   *
+   * @return std::string
+   */
+  virtual std::string execute() const final {
+    return execute_rope().flatten();
+  }
+
+  /**
+   * @note The base Component may implement some default behavior or leave it to
+   * concrete classes (by declaring the method containing the behavior as
+   * "abstract").
+   *
+   * The result is a Rope, so that composites link the results of their
+   * children rather than copying them at every level.
+   *
+   * @return Rope
+   */
+  virtual Rope execute_rope() const = 0;
+
+  /**
+   * @brief Parent setter
+   *
+   * @param parent Parent
+   */
+  void set_parent(Component *parent) { this->parent_ = parent; }
+
+  /**
+   * @brief Parent getter
+   *
+   * @return Component*
+   */
+  Component *get_parent() const { return this->parent_; }
+
+ protected:
+  /**
+   * @brief Parent component
+   *
+   * @note Optionally, the base Component can declare an interface for setting
+   * and accessing a parent of the component in a tree structure. It can also
+   * provide some default implementation for these methods.
+   */
+  Component *parent_{nullptr};
+};
+
+/**
+ * @brief The Leaf class represents the end objects of a composition. A leaf
+ * can't have any children.
+ *
+ * Usually, it's the Leaf objects that do the actual work, whereas Composite
+ * objects only delegate to their sub-components.
+ */
+class Leaf : public Component {
+ public:
+  /**
+   * @brief Constructor
+   */
+  Leaf() = default;
+
+  Leaf(const Leaf &) = delete;
+  Leaf(Leaf &&) = delete;
+  Leaf operator=(const Leaf &) = delete;
+  Leaf operator=(Leaf &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~Leaf() = default;
+
+  /**
+   * @brief Override the implementation of operation()
+   *
+   * @return Rope
+   */
+  Rope execute_rope() const override { return "Leaf"; }
+};
+
+/**
+ * @brief The Composite class represents the complex components that may have
+ * children.
+ *
+ * Usually, the Composite objects delegate the actual work to their children and
+ * then "sum-up" the result.
+ */
+class Composite : public Component {
+ public:
+  /**
+   * @brief Constructor
+   */
+  Composite() = default;
+
+  Composite(const Composite &) = delete;
+  Composite(Composite &&) = delete;
+  Composite operator=(const Composite &) = delete;
+  Composite operator=(Composite &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~Composite() = default;
+
+  /**
+   * @brief add child to composite
+   *
+   * @note A composite object can add or remove other components (both simple or
+   * complex) to or from its child list.
+   */
+  void add(Component *component) override {
+    this->children_.push_back(component);
+    component->set_parent(this);
+  }
+
+  /**
+   * @brief remove child from the composite
+   *
+   * @note Have in mind that this method removes the pointer to the list but
+   * doesn't frees the memory, you should do it manually or better use smart
+   * pointers.
+   */
+  void remove(Component *component) override {
+    children_.remove(component);
+    component->set_parent(nullptr);
+  }
+
+  /**
+   * @brief Check if the object is composite
+   *
+   * @return bool
+   */
+  bool is_composite() const override { return true; }
+
+  /**
+   * @brief Children getter
+   *
+   * @return const std::list<Component *>&
+   */
+  const std::list<Component *> &get_children() const {
+    return this->children_;
+  }
+
+  /**
+   * @note The Composite executes its primary logic in a particular way. It
+   * traverses recursively through all its children, collecting and summing
+   * their results. Since the composite's children pass these calls to their
+   * children and so forth, the whole object tree is traversed as a result.
+   * The results of the children are linked, not copied.
+   */
+  Rope execute_rope() const override {
+    Rope result("Branch(");
+    for (auto c = children_.begin(); c != children_.end(); ++c) {
+      if (c != children_.begin()) result += "+";
+      result += (*c)->execute_rope();
+    }
+    return result + ")";
+  }
+
+ protected:
+  /**
+   * @brief List of children
+   */
+  std::list<Component *> children_;
+};
+
+#endif  // STRUCTURAL_PATTERNS_COMPOSITE_COMPOSITE_H_
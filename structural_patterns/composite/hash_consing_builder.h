@@ -0,0 +1,178 @@
+#ifndef STRUCTURAL_PATTERNS_COMPOSITE_HASH_CONSING_BUILDER_H_
+#define STRUCTURAL_PATTERNS_COMPOSITE_HASH_CONSING_BUILDER_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "composite.h"
+#include "rope.h"
+
+/**
+ * @brief Composite built by HashConsingBuilder: its children are fixed at
+ * construction and may be shared with other composites, so its result is
+ * computed once, on the first evaluation, and reused afterwards.
+ *
+ * @note Shared nodes have several parents: the parent of an interned node is
+ * left unset.
+ */
+class InternedComposite : public Composite {
+ public:
+  InternedComposite() = delete;
+
+  /**
+   * @brief Constructor
+   *
+   * @param children Children, interned
+   */
+  explicit InternedComposite(const std::vector<Component *> &children) {
+    this->children_.assign(children.begin(), children.end());
+  }
+
+  InternedComposite(const InternedComposite &) = delete;
+  InternedComposite(InternedComposite &&) = delete;
+  InternedComposite operator=(const InternedComposite &) = delete;
+  InternedComposite operator=(InternedComposite &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~InternedComposite() = default;
+
+  /**
+   * @brief Interned composites are immutable: every other tree containing the
+   * same subtree would see the change.
+   */
+  void add(Component *component) override {
+    throw std::logic_error("Interned composites are immutable");
+  }
+  void remove(Component *component) override {
+    throw std::logic_error("Interned composites are immutable");
+  }
+
+  /**
+   * @brief Result of the subtree, computed on the first call. Every parent
+   * links the same cached rope.
+   */
+  Rope execute_rope() const override {
+    std::call_once(once_, [this] { result_ = Composite::execute_rope(); });
+    return result_;
+  }
+
+ private:
+  /**
+   * @brief Cached result
+   */
+  mutable std::once_flag once_;
+  mutable Rope result_;
+};
+
+/**
+ * @brief HashConsingBuilder builds trees in which structurally identical
+ * subtrees are stored once, turning them into DAGs.
+ *
+ * Since children are interned before their parent, two subtrees are identical
+ * exactly when they have the same interned children in the same order: a
+ * composite is looked up by the pointers of its children, in a hash table.
+ * Memory and evaluation time then grow with the number of distinct subtrees
+ * rather than with the number of nodes.
+ *
+ * The builder owns the leaf and the composites it builds. intern() only
+ * rebuilds plain Leaf and Composite nodes: any other component, subclasses of
+ * Leaf and Composite included, is kept as it is, stays owned by the caller,
+ * and is only shared when it is the same object.
+ *
+ * @note Not thread-safe: build from one thread, then evaluate from any.
+ */
+class HashConsingBuilder {
+ public:
+  /**
+   * @brief Constructor
+   */
+  HashConsingBuilder() = default;
+
+  HashConsingBuilder(const HashConsingBuilder &) = delete;
+  HashConsingBuilder(HashConsingBuilder &&) = delete;
+  HashConsingBuilder operator=(const HashConsingBuilder &) = delete;
+  HashConsingBuilder operator=(HashConsingBuilder &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~HashConsingBuilder() = default;
+
+  /**
+   * @brief The leaf, shared by every tree of the builder
+   */
+  Component *leaf() { return &leaf_; }
+
+  /**
+   * @brief Composite with `children` (interned), shared with every identical
+   * composite built before
+   */
+  Component *branch(const std::vector<Component *> &children) {
+    auto &node = composites_[children];
+    if (!node) node = std::make_unique<InternedComposite>(children);
+    return node.get();
+  }
+
+  /**
+   * @brief Interned copy of `tree`, which is left untouched. Subtrees whose
+   * root is neither a plain Leaf nor a plain Composite are kept as they are.
+   */
+  Component *intern(Component *tree) {
+    if (typeid(*tree) == typeid(Leaf)) return leaf();
+    if (typeid(*tree) != typeid(Composite) &&
+        typeid(*tree) != typeid(InternedComposite)) {
+      return tree;
+    }
+    const auto *composite = static_cast<const Composite *>(tree);
+
+    std::vector<Component *> children;
+    children.reserve(composite->get_children().size());
+    for (Component *child : composite->get_children()) {
+      children.push_back(intern(child));
+    }
+    return branch(children);
+  }
+
+  /**
+   * @brief Number of distinct composites built
+   */
+  size_t distinct_composites() const { return composites_.size(); }
+
+ private:
+  /**
+   * @brief Hash of the children of a composite
+   */
+  struct ChildrenHash {
+    size_t operator()(const std::vector<Component *> &children) const {
+      size_t hash = children.size();
+      for (const Component *child : children) {
+        hash ^= std::hash<const Component *>()(child) + 0x9e3779b97f4a7c15ull +
+                (hash << 6) + (hash >> 2);
+      }
+      return hash;
+    }
+  };
+
+  /**
+   * @brief The leaf
+   */
+  Leaf leaf_;
+
+  /**
+   * @brief Distinct composites, by children
+   */
+  std::unordered_map<std::vector<Component *>,
+                     std::unique_ptr<InternedComposite>, ChildrenHash>
+      composites_;
+};
+
+#endif  // STRUCTURAL_PATTERNS_COMPOSITE_HASH_CONSING_BUILDER_H_
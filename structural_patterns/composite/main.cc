@@ -1,8 +1,13 @@
-#include <algorithm>
 #include <iostream>
-#include <list>
 #include <memory>
 #include <string>
+#include <vector>
+
+#include "bulk_tree.h"
+#include "composite.h"
+#include "hash_consing_builder.h"
+#include "persistent_composite.h"
+#include "subtree_search.h"
 
 /**
  * @brief Composite is a "structural design pattern" that lets you compose
@@ -53,188 +58,11 @@
 
 //////////////////////////////////////////////////////////////////////
 
-/**
- * @brief The base Component class declares common operations for both simple
- * and complex objects of a composition.
- */
-class Component {
- public:
-  /**
-   * @brief Constructor
-   */
-  Component() = default;
-
-  Component(const Component &) = delete;
-  Component(Component &&) = delete;
-
-  /**
-   * @brief Destructor
-   */
-  virtual ~Component() = default;
-
-  /**
-   * @note In some cases, it would be beneficial to define the child-management
-   * operations right in the base Component class. This way, you won't need to
-   * expose any concrete component classes to the client code, even during the
-   * object tree assembly. The downside is that these methods will be empty for
-   * the leaf-level components. => CONS
-   */
-  virtual void add(Component *component) {}
-  virtual void remove(Component *component) {}
-
-  /**
-   * @brief Check if object is composite
-   */
-  virtual bool is_composite() const { return false; }
-
-  /**
-   * @note The base Component may implement some default behavior or leave it to
-   * concrete classes (by declaring the method containing the behavior as
-   * "abstract").
-   */
-  virtual std::string execute() const = 0;
-
-  /**
-   * @brief Parent setter
-   *
-   * @param parent Parent
-   */
-  void set_parent(Component *parent) { this->parent_ = parent; }
-
-  /**
-   * @brief Parent getter
-   *
-   * @return Component*
-   */
-  Component *get_parent() const { return this->parent_; }
-
- protected:
-  /**
-   * @brief Parent component
-   *
-   * @note Optionally, the base Component can declare an interface for setting
-   * and accessing a parent of the component in a tree structure. It can also
-   * provide some default implementation for these methods.
-   */
-  Component *parent_;
-};
-
-/**
- * @brief The Leaf class represents the end objects of a composition. A leaf
- * can't have any children.
- *
- * Usually, it's the Leaf objects that do the actual work, whereas Composite
- * objects only delegate to their sub-components.
- */
-class Leaf : public Component {
- public:
-  /**
-   * @brief Constructor
-   */
-  Leaf() = default;
-
-  Leaf(const Leaf &) = delete;
-  Leaf(Leaf &&) = delete;
-  Leaf operator=(const Leaf &) = delete;
-  Leaf operator=(Leaf &&) = delete;
-
-  /**
-   * @brief Destructor
-   */
-  ~Leaf() = default;
-
-  /**
-   * @brief Override the implementation of operation()
-   *
-   * @return std::string
-   */
-  std::string execute() const override { return "Leaf"; }
-};
-
-/**
- * @brief The Composite class represents the complex components that may have
- * children.
- *
- * Usually, the Composite objects delegate the actual work to their children and
- * then "sum-up" the result.
- */
-class Composite : public Component {
- public:
-  /**
-   * @brief Constructor
-   */
-  Composite() = default;
-
-  Composite(const Composite &) = delete;
-  Composite(Composite &&) = delete;
-  Composite operator=(const Composite &) = delete;
-  Composite operator=(Composite &&) = delete;
-
-  /**
-   * @brief Destructor
-   */
-  ~Composite() = default;
-
-  /**
-   * @brief add child to composite
-   *
-   * @note A composite object can add or remove other components (both simple or
-   * complex) to or from its child list.
-   */
-  void add(Component *component) override {
-    this->children_.push_back(component);
-    component->set_parent(this);
-  }
-
-  /**
-   * @brief remove child from the composite
-   *
-   * @note Have in mind that this method removes the pointer to the list but
-   * doesn't frees the memory, you should do it manually or better use smart
-   * pointers.
-   */
-  void remove(Component *component) override {
-    children_.remove(component);
-    component->set_parent(nullptr);
-  }
-
-  /**
-   * @brief Check if the object is composite
-   *
-   * @return bool
-   */
-  bool is_composite() const override { return true; }
-
-  /**
-   * @note The Composite executes its primary logic in a particular way. It
-   * traverses recursively through all its children, collecting and summing
-   * their results. Since the composite's children pass these calls to their
-   * children and so forth, the whole object tree is traversed as a result.
-   */
-  std::string execute() const override {
-    std::string result;
-    for (const auto &c : children_) {
-      if (c == children_.back()) {
-        result += c->execute();
-      } else {
-        result += c->execute() + "+";
-      }
-    }
-    return "Branch(" + result + ")";
-  }
-
- protected:
-  /**
-   * @brief List of children
-   */
-  std::list<Component *> children_;
-};
-
 /**
  * @brief The client code works with all of the components via the base
  * interface.
  */
-void run_client(Component *component) {
+void run_client(const Component *component) {
   std::cout << "RESULT: " << component->execute();
 }
 
@@ -269,5 +97,88 @@ int main() {
   run_client(tree.get());
   std::cout << "\n\n";
 
+  /**
+   * Identical subtrees stored once.
+   */
+  HashConsingBuilder builder;
+  Component *bundle = builder.branch({builder.leaf(), builder.leaf()});
+  Component *catalog = builder.branch(
+      {bundle, bundle, builder.intern(tree.get()), builder.intern(tree.get())});
+  std::cout << "Client: Identical subtrees are shared ("
+            << builder.distinct_composites() << " distinct composites):\n";
+  run_client(catalog);
+  std::cout << "\n\n";
+
+  /**
+   * Results written piece by piece, without building the whole string.
+   */
+#if defined(__unix__) || defined(__APPLE__)
+  std::cout << "Client: The same result, written with scatter/gather I/O:\n"
+            << std::flush;
+  catalog->execute_rope().write(STDOUT_FILENO);
+  std::cout << "\n\n";
+#endif
+
+  /**
+   * Immutable versions sharing their unchanged subtrees.
+   */
+  PersistentTree versions;
+  versions.add({}, std::make_shared<PersistentComposite>());
+  versions.add({0}, std::make_shared<Leaf>());
+  const auto before = versions.snapshot();
+  versions.add({0}, std::make_shared<Leaf>());
+  versions.add({}, std::make_shared<Leaf>());
+  std::cout << "Client: A snapshot is unaffected by later changes:\n";
+  run_client(before.get());
+  std::cout << "\n";
+  run_client(versions.snapshot().get());
+  std::cout << "\n\n";
+
+  /**
+   * Whole trees built at once from a parent array or an edge list.
+   */
+  const BulkTree from_parents({BulkTree::cNoParent, 0, 0, 1, 1, 2});
+  const BulkTree from_edges(6, {{0, 1}, {0, 2}, {1, 3}, {1, 4}, {2, 5}});
+  std::cout << "Client: Trees can be loaded in bulk:\n";
+  run_client(from_parents.node(from_parents.roots().front()));
+  std::cout << "\n";
+  run_client(from_edges.node(from_edges.roots().front()));
+  std::cout << "\n\n";
+
+  /**
+   * Searches skipping the branches whose summary rules out a match.
+   */
+  KeyedLeaf apple(1, {"fruit"}), pear(2, {"fruit"}), leek(3, {"vegetable"});
+  KeyedLeaf cherry(11, {"fruit"}), chard(12, {"vegetable"});
+  SummarizedComposite basket_1, basket_2, market;
+  basket_1.add(&apple);
+  basket_1.add(&pear);
+  basket_1.add(&leek);
+  basket_2.add(&cherry);
+  basket_2.add(&chard);
+  market.add(&basket_1);
+  market.add(&basket_2);
+
+  LeafQuery query;
+  query.min_key = 10;
+  query.tags = {"fruit"};
+  std::cout << "Client: Leaves tagged \"fruit\" with a key of at least 10:\n";
+  for (const KeyedLeaf *leaf : find_leaves(&market, query, 2)) {
+    std::cout << "RESULT: " << leaf->execute() << " " << leaf->get_key()
+              << "\n";
+  }
+  std::cout << "\n";
+
+  /**
+   * Wide trees, whose results are long chains of pieces.
+   */
+  std::vector<Leaf> leaves(1000000);
+  Composite wide;
+  for (Leaf &leaf : leaves) wide.add(&leaf);
+  std::cout << "Client: A composite with " << leaves.size()
+            << " leaves gives a result of " << wide.execute().size()
+            << " bytes\n";
+  std::cout << "\n";
+
   return 0;
 }
@@ -0,0 +1,214 @@
+#ifndef STRUCTURAL_PATTERNS_COMPOSITE_PERSISTENT_COMPOSITE_H_
+#define STRUCTURAL_PATTERNS_COMPOSITE_PERSISTENT_COMPOSITE_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "composite.h"
+#include "rope.h"
+
+/**
+ * @brief Immutable Composite: instead of changing the tree in place, edits
+ * return a new root sharing every unchanged subtree with the old one (path
+ * copying). Only the composites on the path from the root to the edited one
+ * are copied.
+ *
+ * A root is therefore a snapshot: it can be evaluated, from any thread and
+ * without locks, while newer versions are built. Nodes are shared by several
+ * versions, so their parent is left unset.
+ */
+class PersistentComposite : public Component {
+ public:
+  /**
+   * @brief Shared, immutable node
+   */
+  using Node = std::shared_ptr<const Component>;
+  using Root = std::shared_ptr<const PersistentComposite>;
+
+  /**
+   * @brief Constructor
+   *
+   * @param children Children
+   */
+  explicit PersistentComposite(std::vector<Node> children = {})
+      : children_(std::move(children)){};
+
+  PersistentComposite(const PersistentComposite &) = delete;
+  PersistentComposite(PersistentComposite &&) = delete;
+  PersistentComposite operator=(const PersistentComposite &) = delete;
+  PersistentComposite operator=(PersistentComposite &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~PersistentComposite() = default;
+
+  /**
+   * @brief Persistent composites cannot change in place, see with_added() and
+   * with_removed().
+   */
+  void add(Component *component) override {
+    throw std::logic_error("Persistent composites are immutable");
+  }
+  void remove(Component *component) override {
+    throw std::logic_error("Persistent composites are immutable");
+  }
+
+  /**
+   * @brief Check if the object is composite
+   *
+   * @return bool
+   */
+  bool is_composite() const override { return true; }
+
+  /**
+   * @brief Same result as Composite::execute_rope()
+   */
+  Rope execute_rope() const override {
+    Rope result("Branch(");
+    for (size_t i = 0; i < children_.size(); ++i) {
+      if (i) result += "+";
+      result += children_[i]->execute_rope();
+    }
+    return result + ")";
+  }
+
+  /**
+   * @brief Children getter
+   *
+   * @return const std::vector<Node>&
+   */
+  const std::vector<Node> &get_children() const { return this->children_; }
+
+  /**
+   * @brief New version of this tree, where `child` is appended to the
+   * composite at `path`
+   *
+   * @param path Child indices leading from this composite to the edited one
+   * @param child Child to add
+   */
+  Root with_added(const std::vector<size_t> &path, Node child) const {
+    return edit(path, 0, [&child](std::vector<Node> &children) {
+      children.push_back(std::move(child));
+    });
+  }
+
+  /**
+   * @brief New version of this tree, where child `index` of the composite at
+   * `path` is removed
+   *
+   * @param path Child indices leading from this composite to the edited one
+   * @param index Index of the child to remove
+   */
+  Root with_removed(const std::vector<size_t> &path, size_t index) const {
+    return edit(path, 0, [index](std::vector<Node> &children) {
+      if (index >= children.size()) {
+        throw std::out_of_range("No such child");
+      }
+      children.erase(children.begin() + index);
+    });
+  }
+
+ private:
+  /**
+   * @brief Copy of this composite with `change` applied to the children of
+   * the composite at `path[depth...]`, copying the composites in between.
+   */
+  template <typename Change>
+  Root edit(const std::vector<size_t> &path, size_t depth,
+            Change &&change) const {
+    std::vector<Node> children = children_;
+    if (depth == path.size()) {
+      change(children);
+    } else {
+      if (path[depth] >= children.size()) {
+        throw std::out_of_range("No such child");
+      }
+      const auto child = std::dynamic_pointer_cast<const PersistentComposite>(
+          children[path[depth]]);
+      if (!child) throw std::invalid_argument("Path goes through a leaf");
+      children[path[depth]] =
+          child->edit(path, depth + 1, std::forward<Change>(change));
+    }
+    return std::make_shared<const PersistentComposite>(std::move(children));
+  }
+
+  /**
+   * @brief Children
+   */
+  const std::vector<Node> children_;
+};
+
+/**
+ * @brief PersistentTree publishes successive versions of a PersistentComposite
+ * tree.
+ *
+ * Readers take a snapshot, which stays valid and unchanged for as long as they
+ * hold it, and never wait for writers beyond copying the root pointer. Writers
+ * are serialized: each builds the next version from the latest one and
+ * publishes its root.
+ */
+class PersistentTree {
+ public:
+  /**
+   * @brief Constructor
+   *
+   * @param root Initial version
+   */
+  explicit PersistentTree(
+      PersistentComposite::Root root = std::make_shared<PersistentComposite>())
+      : root_(std::move(root)){};
+
+  PersistentTree(const PersistentTree &) = delete;
+  PersistentTree(PersistentTree &&) = delete;
+  PersistentTree operator=(const PersistentTree &) = delete;
+  PersistentTree operator=(PersistentTree &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~PersistentTree() = default;
+
+  /**
+   * @brief Current version
+   */
+  PersistentComposite::Root snapshot() const {
+    return std::atomic_load(&root_);
+  }
+
+  /**
+   * @brief Publish a version where `child` is appended to the composite at
+   * `path`
+   */
+  void add(const std::vector<size_t> &path, PersistentComposite::Node child) {
+    std::lock_guard<std::mutex> lock(writer_);
+    std::atomic_store(&root_, root_->with_added(path, std::move(child)));
+  }
+
+  /**
+   * @brief Publish a version where child `index` of the composite at `path` is
+   * removed
+   */
+  void remove(const std::vector<size_t> &path, size_t index) {
+    std::lock_guard<std::mutex> lock(writer_);
+    std::atomic_store(&root_, root_->with_removed(path, index));
+  }
+
+ private:
+  /**
+   * @brief Current version, only accessed atomically
+   */
+  PersistentComposite::Root root_;
+
+  /**
+   * @brief Serializes writers
+   */
+  std::mutex writer_;
+};
+
+#endif  // STRUCTURAL_PATTERNS_COMPOSITE_PERSISTENT_COMPOSITE_H_
@@ -0,0 +1,328 @@
+#ifndef STRUCTURAL_PATTERNS_COMPOSITE_SUBTREE_SEARCH_H_
+#define STRUCTURAL_PATTERNS_COMPOSITE_SUBTREE_SEARCH_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "composite.h"
+
+/**
+ * @brief Summary of the leaves of a subtree, used to skip subtrees that
+ * cannot hold a match: range of their keys and Bloom filter of their tags.
+ */
+struct LeafSummary {
+  int64_t min_key{std::numeric_limits<int64_t>::max()};
+  int64_t max_key{std::numeric_limits<int64_t>::min()};
+  uint64_t tags{0};
+
+  /**
+   * @brief Summary of a subtree whose leaves are not known, which is never
+   * skipped
+   */
+  static LeafSummary unknown() {
+    return LeafSummary{std::numeric_limits<int64_t>::min(),
+                       std::numeric_limits<int64_t>::max(), ~uint64_t{0}};
+  }
+
+  /**
+   * @brief Bloom filter bits of `tag`
+   */
+  static uint64_t bits_of(const std::string &tag) {
+    const size_t hash = std::hash<std::string>()(tag);
+    return (uint64_t{1} << (hash & 63)) | (uint64_t{1} << ((hash >> 6) & 63));
+  }
+
+  /**
+   * @brief Add the leaves of `other`
+   */
+  void merge(const LeafSummary &other) {
+    min_key = std::min(min_key, other.min_key);
+    max_key = std::max(max_key, other.max_key);
+    tags |= other.tags;
+  }
+};
+
+/**
+ * @brief Leaf carrying a key and tags, which queries select leaves by
+ */
+class KeyedLeaf : public Leaf {
+ public:
+  KeyedLeaf() = delete;
+
+  /**
+   * @brief Constructor
+   *
+   * @param key Key
+   * @param tags Tags
+   */
+  explicit KeyedLeaf(int64_t key, std::vector<std::string> tags = {})
+      : key_(key), tags_(std::move(tags)) {
+    summary_.min_key = summary_.max_key = key_;
+    for (const auto &tag : tags_) summary_.tags |= LeafSummary::bits_of(tag);
+  }
+
+  KeyedLeaf(const KeyedLeaf &) = delete;
+  KeyedLeaf(KeyedLeaf &&) = delete;
+  KeyedLeaf operator=(const KeyedLeaf &) = delete;
+  KeyedLeaf operator=(KeyedLeaf &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~KeyedLeaf() = default;
+
+  /**
+   * @brief Key getter
+   */
+  int64_t get_key() const { return key_; }
+
+  /**
+   * @brief Check if the leaf carries `tag`
+   */
+  bool has_tag(const std::string &tag) const {
+    return std::find(tags_.begin(), tags_.end(), tag) != tags_.end();
+  }
+
+  /**
+   * @brief Summary of this leaf alone
+   */
+  const LeafSummary &get_summary() const { return summary_; }
+
+ private:
+  /**
+   * @brief Key and tags
+   */
+  const int64_t key_;
+  const std::vector<std::string> tags_;
+
+  /**
+   * @brief Summary of this leaf alone
+   */
+  LeafSummary summary_;
+};
+
+/**
+ * @brief Composite keeping the summary of the leaves of its subtree up to
+ * date.
+ *
+ * add() merges the summary of the new child into this composite and its
+ * summarized ancestors, O(depth). remove() recomputes them from their
+ * children, as a key range cannot shrink by subtraction.
+ *
+ * @note Summaries are only kept in sync by add() and remove() on summarized
+ * composites: children added to other composites of the subtree are seen as
+ * unknown, not missed.
+ */
+class SummarizedComposite : public Composite {
+ public:
+  /**
+   * @brief Constructor
+   */
+  SummarizedComposite() = default;
+
+  SummarizedComposite(const SummarizedComposite &) = delete;
+  SummarizedComposite(SummarizedComposite &&) = delete;
+  SummarizedComposite operator=(const SummarizedComposite &) = delete;
+  SummarizedComposite operator=(SummarizedComposite &&) = delete;
+
+  /**
+   * @brief Destructor
+   */
+  ~SummarizedComposite() = default;
+
+  /**
+   * @brief add child, merging its summary into the ancestors
+   */
+  void add(Component *component) override {
+    Composite::add(component);
+    const LeafSummary added = summary_of(component);
+    for (SummarizedComposite *node = this; node;
+         node = node->summarized_parent()) {
+      node->summary_.merge(added);
+    }
+  }
+
+  /**
+   * @brief remove child, recomputing the summary of the ancestors
+   */
+  void remove(Component *component) override {
+    Composite::remove(component);
+    for (SummarizedComposite *node = this; node;
+         node = node->summarized_parent()) {
+      node->summary_ = LeafSummary();
+      for (const Component *child : node->children_) {
+        node->summary_.merge(summary_of(child));
+      }
+    }
+  }
+
+  /**
+   * @brief Summary of the leaves of this subtree
+   */
+  const LeafSummary &get_summary() const { return summary_; }
+
+  /**
+   * @brief Summary of `component`: exact for keyed leaves and summarized
+   * composites, unknown for other composites, empty for other components
+   * (which queries never select)
+   */
+  static LeafSummary summary_of(const Component *component) {
+    if (const auto *leaf = dynamic_cast<const KeyedLeaf *>(component)) {
+      return leaf->get_summary();
+    }
+    if (const auto *summarized =
+            dynamic_cast<const SummarizedComposite *>(component)) {
+      return summarized->get_summary();
+    }
+    if (dynamic_cast<const Composite *>(component)) {
+      return LeafSummary::unknown();
+    }
+    return LeafSummary();
+  }
+
+ private:
+  /**
+   * @brief Parent, if summarized
+   */
+  SummarizedComposite *summarized_parent() const {
+    return dynamic_cast<SummarizedComposite *>(this->parent_);
+  }
+
+  /**
+   * @brief Summary of the leaves of this subtree
+   */
+  LeafSummary summary_;
+};
+
+/**
+ * @brief Query selecting keyed leaves: the key range and required tags are
+ * checked against subtree summaries to skip whole branches, then `predicate`
+ * (if any) is checked on the leaves left.
+ */
+struct LeafQuery {
+  int64_t min_key{std::numeric_limits<int64_t>::min()};
+  int64_t max_key{std::numeric_limits<int64_t>::max()};
+  std::vector<std::string> tags;
+  std::function<bool(const KeyedLeaf &)> predicate;
+
+  /**
+   * @brief Check if a subtree summarized by `summary` may hold a match
+   */
+  bool may_match(const LeafSummary &summary) const {
+    if (summary.max_key < min_key || summary.min_key > max_key) return false;
+    for (const auto &tag : tags) {
+      const uint64_t bits = LeafSummary::bits_of(tag);
+      if ((summary.tags & bits) != bits) return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Check if `leaf` matches
+   */
+  bool matches(const KeyedLeaf &leaf) const {
+    if (leaf.get_key() < min_key || leaf.get_key() > max_key) return false;
+    for (const auto &tag : tags) {
+      if (!leaf.has_tag(tag)) return false;
+    }
+    return !predicate || predicate(leaf);
+  }
+};
+
+/**
+ * @brief Find the keyed leaves of the tree under `root` matching `query`, in
+ * tree order, skipping the subtrees whose summary rules out a match.
+ *
+ * With several threads, the tree is first split into at least a few subtrees
+ * per thread (pruned as well), which the threads then search concurrently.
+ *
+ * @note The tree must not change during the search.
+ *
+ * @param root Root
+ * @param query Query
+ * @param threads Number of threads
+ */
+inline std::vector<const KeyedLeaf *> find_leaves(const Component *root,
+                                                  const LeafQuery &query,
+                                                  size_t threads = 1) {
+  // Children of `node` that may hold a match, in order
+  auto candidates = [&query](const Component *node,
+                             std::vector<const Component *> *out) {
+    const auto *composite = dynamic_cast<const Composite *>(node);
+    if (!composite) return;
+    for (const Component *child : composite->get_children()) {
+      if (query.may_match(SummarizedComposite::summary_of(child))) {
+        out->push_back(child);
+      }
+    }
+  };
+
+  // Depth-first search of one subtree, explicit stack for deep trees
+  auto search = [&](const Component *subtree,
+                    std::vector<const KeyedLeaf *> *found) {
+    std::vector<const Component *> pending{subtree};
+    std::vector<const Component *> children;
+    while (!pending.empty()) {
+      const Component *node = pending.back();
+      pending.pop_back();
+      if (const auto *leaf = dynamic_cast<const KeyedLeaf *>(node)) {
+        if (query.matches(*leaf)) found->push_back(leaf);
+        continue;
+      }
+      children.clear();
+      candidates(node, &children);
+      pending.insert(pending.end(), children.rbegin(), children.rend());
+    }
+  };
+
+  std::vector<const Component *> frontier;
+  if (query.may_match(SummarizedComposite::summary_of(root))) {
+    frontier.push_back(root);
+  }
+
+  // Expand the frontier level by level until every thread has a few subtrees
+  const size_t wanted = threads > 1 ? 4 * threads : 1;
+  for (bool expanded = true; expanded && frontier.size() < wanted;) {
+    expanded = false;
+    std::vector<const Component *> next;
+    for (const Component *node : frontier) {
+      if (dynamic_cast<const Composite *>(node)) {
+        candidates(node, &next);
+        expanded = true;
+      } else {
+        next.push_back(node);
+      }
+    }
+    frontier.swap(next);
+  }
+
+  std::vector<std::vector<const KeyedLeaf *>> found(frontier.size());
+  std::atomic<size_t> next{0};
+  auto work = [&] {
+    for (size_t i; (i = next.fetch_add(1)) < frontier.size();) {
+      search(frontier[i], &found[i]);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t t = 1; t < std::min(threads, frontier.size()); ++t) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto &worker : workers) worker.join();
+
+  std::vector<const KeyedLeaf *> leaves;
+  for (const auto &subtree : found) {
+    leaves.insert(leaves.end(), subtree.begin(), subtree.end());
+  }
+  return leaves;
+}
+
+#endif  // STRUCTURAL_PATTERNS_COMPOSITE_SUBTREE_SEARCH_H_
@@ -1,5 +1,9 @@
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
+
+#include "rope.h"
 
 /**
  * @brief "Decorator" is a structural design pattern that lets you attach new
@@ -78,11 +82,24 @@ class Component {
   virtual ~Component() = default;
 
   /**
-   * @brief Execution
+   * @brief Execution, execute_rope() flattened. Final, so that execute_rope()
+   * is the only operation decorators alter and none of them is bypassed.
    *
    * @return std::string
    */
-  virtual std::string execute() const = 0;
+  virtual std::string execute() const final {
+    return execute_rope().flatten();
+  }
+
+  /**
+   * @brief Execution, as a Rope
+   *
+   * @note Decorators link the result of the wrapped component rather than
+   * copying it, so a chain of decorators builds its result in linear time.
+   *
+   * @return Rope
+   */
+  virtual Rope execute_rope() const = 0;
 };
 
 /**
@@ -108,9 +125,9 @@ class ConcreteComponent : public Component {
   /**
    * @brief Execution
    *
-   * @return std::string
+   * @return Rope
    */
-  std::string execute() const override { return "ConcreteComponent"; }
+  Rope execute_rope() const override { return "ConcreteComponent"; }
 };
 
 /**
@@ -139,11 +156,13 @@ class Decorator : public Component {
   virtual ~Decorator() = default;
 
   /**
-   * @brief Execution
+   * @brief Execution, as a Rope
    *
-   * @return std::string
+   * @return Rope
    */
-  std::string execute() const override { return this->component_->execute(); }
+  Rope execute_rope() const override {
+    return this->component_->execute_rope();
+  }
 
  protected:
   /**
@@ -179,12 +198,12 @@ class ConcreteDecoratorA : public Decorator {
   ~ConcreteDecoratorA() = default;
 
   /**
-   * @brief Execution
+   * @brief Execution, as a Rope
    *
-   * @return std::string
+   * @return Rope
    */
-  std::string execute() const override {
-    return "ConcreteDecoratorA(" + Decorator::execute() + ")";
+  Rope execute_rope() const override {
+    return "ConcreteDecoratorA(" + Decorator::execute_rope() + ")";
   }
 };
 
@@ -210,12 +229,12 @@ class ConcreteDecoratorB : public Decorator {
   ~ConcreteDecoratorB() = default;
 
   /**
-   * @brief Execution
+   * @brief Execution, as a Rope
    *
-   * @return std::string
+   * @return Rope
    */
-  std::string execute() const override {
-    return "ConcreteDecoratorB(" + Decorator::execute() + ")";
+  Rope execute_rope() const override {
+    return "ConcreteDecoratorB(" + Decorator::execute_rope() + ")";
   }
 };
 
@@ -247,5 +266,22 @@ int main() {
   run_client(decorator_2.get());
   std::cout << "\n\n";
 
+  /**
+   * Deep chains of decorators build their result in linear time.
+   */
+  std::vector<std::unique_ptr<Component>> chain;
+  Component *decorated = simple.get();
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 2) {
+      chain.push_back(std::make_unique<ConcreteDecoratorB>(decorated));
+    } else {
+      chain.push_back(std::make_unique<ConcreteDecoratorA>(decorated));
+    }
+    decorated = chain.back().get();
+  }
+  std::cout << "Client: Now I've got " << chain.size()
+            << " decorators, rendering "
+            << decorated->execute_rope().size() << " characters\n\n";
+
   return 0;
 }